@@ -0,0 +1,204 @@
+//------------------------------------------------------------------------------
+/**
+ * @file fb_bench.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief lib_fb / lib_ui rendering benchmark (offscreen surface).
+ * @version 0.1
+ * @date 2026-10-17
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+
+#include "typedefs.h"
+#include "lib_fb.h"
+#include "lib_ui.h"
+
+//------------------------------------------------------------------------------
+/*
+	결과는 1 line 1 항목, key=value 형식으로 출력한다.
+	bench=<name> res=<w>x<h> fmt=<format> scale=<n> cache=<on|off> iters=<n> value=<v> unit=<unit>
+*/
+//------------------------------------------------------------------------------
+const char	*OPT_UI_CFG_FILE	= "default_ui.cfg";
+int			OPT_CASE_MS			= 100;
+
+static const char *BENCH_RES[] = { "800x480", "1280x720", "1920x1080" };
+static const int   BENCH_BPP[] = { 16, 24, 32 };
+
+#define	BENCH_SCALE_MAX		8
+#define	BENCH_ASCII_STR		"ODROID-H3 I2C 0123456789"
+#define	BENCH_HANGUL_STR	"하드커널 오드로이드 테스트"
+
+//------------------------------------------------------------------------------
+static double now_ns (void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+static void report (const char *name, fb_info_t *fb, int scale, bool cache,
+					long iters, double value, const char *unit)
+{
+	printf("bench=%s res=%dx%d fmt=%s scale=%d cache=%s iters=%ld value=%.1f unit=%s\n",
+		name, fb->w, fb->h, fb->fmt->name, scale, cache ? "on" : "off",
+		iters, value, unit);
+	fflush(stdout);
+}
+
+//------------------------------------------------------------------------------
+static void bench_fill_rect (fb_info_t *fb)
+{
+	double start, elapsed;
+	long iters = 0;
+
+	start = now_ns();
+	do {
+		draw_fill_rect (fb, 0, 0, fb->w, fb->h, (iters & 1) ? COLOR_RED : COLOR_BLUE);
+		iters++;
+	} while ((elapsed = now_ns() - start) < OPT_CASE_MS * 1e6);
+
+	report ("fill_rect", fb, 0, false, iters,
+		(double)fb->w * fb->h * iters * 1e9 / elapsed, "pixels/s");
+}
+
+//------------------------------------------------------------------------------
+static int glyph_count (const char *str)
+{
+	int cnt = 0;
+
+	for (; *str; str++)
+		if ((*str & 0xC0) != 0x80)
+			cnt++;
+	return cnt;
+}
+
+//------------------------------------------------------------------------------
+static void bench_text (fb_info_t *fb, const char *name, const char *str, bool cache)
+{
+	double start, elapsed;
+	long iters;
+	int scale, glyphs = glyph_count(str);
+
+	fb_glyph_cache_size(cache ? 2 * 1024 * 1024 : 0);
+	for (scale = 1; scale <= BENCH_SCALE_MAX; scale++) {
+		if ((FONT_HEIGHT * scale) > fb->h)
+			break;
+		iters = 0;
+		start = now_ns();
+		do {
+			draw_text (fb, 0, 0, COLOR_WHITE, COLOR_NAVY, scale, "%s", str);
+			iters++;
+		} while ((elapsed = now_ns() - start) < OPT_CASE_MS * 1e6);
+
+		report (name, fb, scale, cache, iters,
+			(double)glyphs * iters * 1e9 / elapsed, "glyphs/s");
+	}
+	fb_glyph_cache_size(2 * 1024 * 1024);
+}
+
+//------------------------------------------------------------------------------
+static void bench_ui (fb_info_t *fb)
+{
+	double start, elapsed;
+	ui_grp_t *ui;
+	long iters;
+
+	/* source tree에 layout cache 파일을 남기지 않는다. */
+	setenv ("UI_NO_CACHE", "1", 1);
+	if ((ui = ui_init (fb, OPT_UI_CFG_FILE)) == NULL) {
+		err ("%s ui init fail!\n", OPT_UI_CFG_FILE);
+		return;
+	}
+	fb_flush (fb);
+
+	/* 전체 화면 갱신 */
+	iters = 0;
+	start = now_ns();
+	do {
+		ui_update (fb, ui, -1);
+		fb_flush (fb);
+		iters++;
+	} while ((elapsed = now_ns() - start) < OPT_CASE_MS * 1e6);
+	report ("ui_update_all", fb, 0, true, iters, elapsed / iters, "ns/update");
+
+	/* 1초마다 바뀌는 시계 문자열 갱신 */
+	iters = 0;
+	start = now_ns();
+	do {
+		ui_set_str (fb, ui, 1, -1, -1, 3, -1, "2026/10/17, 12:%02ld:%02ld",
+					(iters / 60) % 60, iters % 60);
+		ui_flush (fb, ui);
+		fb_flush (fb);
+		iters++;
+	} while ((elapsed = now_ns() - start) < OPT_CASE_MS * 1e6);
+	report ("ui_set_str", fb, 3, true, iters, elapsed / iters, "ns/update");
+
+	ui_close (ui);
+}
+
+//------------------------------------------------------------------------------
+static void print_usage (const char *prog)
+{
+	printf("Usage: %s [-ut]\n", prog);
+	puts("  -u --ui_cfg_file     default name is default_ui.cfg\n"
+		 "  -t --time_ms         run time of each case (default 100 ms)\n"
+	);
+	exit(1);
+}
+
+//------------------------------------------------------------------------------
+int main (int argc, char **argv)
+{
+	static const struct option lopts[] = {
+		{ "ui_config_file"	, 1, 0, 'u' },
+		{ "time_ms"			, 1, 0, 't' },
+		{ NULL, 0, 0, 0 },
+	};
+	unsigned int r, b;
+	int c;
+
+	while ((c = getopt_long(argc, argv, "u:t:", lopts, NULL)) != -1) {
+		switch (c) {
+		case 'u':	OPT_UI_CFG_FILE = optarg;		break;
+		case 't':	OPT_CASE_MS = atoi(optarg);		break;
+		default:	print_usage(argv[0]);			break;
+		}
+	}
+
+	for (r = 0; r < sizeof(BENCH_RES) / sizeof(BENCH_RES[0]); r++) {
+		for (b = 0; b < sizeof(BENCH_BPP) / sizeof(BENCH_BPP[0]); b++) {
+			char spec[64];
+			fb_info_t *fb;
+
+			sprintf(spec, "mem:%sx%d", BENCH_RES[r], BENCH_BPP[b]);
+			if ((fb = fb_init (spec)) == NULL) {
+				err ("%s surface create fail!\n", spec);
+				continue;
+			}
+			fb_shadow_enable (fb, true);
+
+			bench_fill_rect (fb);
+			bench_text (fb, "text_ascii",  BENCH_ASCII_STR,  true);
+			bench_text (fb, "text_ascii",  BENCH_ASCII_STR,  false);
+			bench_text (fb, "text_hangul", BENCH_HANGUL_STR, true);
+			bench_text (fb, "text_hangul", BENCH_HANGUL_STR, false);
+			bench_ui (fb);
+
+			fb_close (fb);
+		}
+	}
+	return 0;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
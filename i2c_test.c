@@ -14,6 +14,11 @@
 #include <errno.h>
 #include <fcntl.h>
 #include <getopt.h>
+#include <libgen.h>
+#include <limits.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -28,6 +33,7 @@
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/inotify.h>
 #include <sys/ioctl.h>
 #include <sys/socket.h>
 
@@ -35,6 +41,27 @@
 #define DUPLEX_HALF 0x00
 #define DUPLEX_FULL 0x01
 
+/* 검사 결과를 표시하는 widget의 박스 id (ui config W command) */
+#define APP_LOG_ID	10	/* LOG   : pass/fail 변경, link 변경 */
+#define APP_LAT_ID	11	/* SPARK : I2C 전송 응답 시간 (usec, lib_i2c 측정) */
+#define APP_ERR_ID	12	/* SPARK : 검사 주기별 실패 항목 수 (soak : 초당 실패한 전송 수) */
+#define APP_HIST_ID	13	/* HIST  : I2C 전송 응답 시간 분포 */
+/* soak mode : LAT/HIST = 1초 동안의 전송 p99 (usec), 초당 전송 수는 adapter 박스에 표시 */
+
+/* scan mode (scan_ui.cfg) : bus 별 결과 문자열 / 주소 GRID 박스 id, scan 시간 */
+#define APP_SCAN_ID			2
+#define APP_GRID_ID			4
+#define APP_SCAN_TIME_ID	9
+
+/* scan 결과 GRID 셀 색상 */
+#define SCAN_COLOR_OK		0x00C000	/* 있어야 하는 device 있음 */
+#define SCAN_COLOR_EXTRA	0xFFFF00	/* 설정되지 않은 device 있음 */
+#define SCAN_COLOR_MISSING	0xFF0000	/* 있어야 하는 device 없음 */
+#define SCAN_COLOR_EMPTY	0x303030	/* device 없음 */
+
+/* ui config에 adapter 별 박스가 있는 검사 대상 수 (default_ui.cfg, scan_ui.cfg) */
+#define APP_UI_TARGETS		2
+
 #define ETHTOOL_GSET 0x00000001 /* Get settings command for ethtool */
 
 struct ethtool_cmd {
@@ -64,27 +91,12 @@ struct ethtool_cmd {
 /* file parser control 함수 */
 #include "lib_ui.h"
 
+/* i2c-dev adapter handle 함수 */
+#include "lib_i2c.h"
+
 #include "i2c_test.h"
 
 //------------------------------------------------------------------------------
-//------------------------------------------------------------------------------
-__s32 i2c_smbus_access(int file, char read_write, __u8 command,
-		       int size, union i2c_smbus_data *data)
-{
-	struct i2c_smbus_ioctl_data args;
-	__s32 err;
-
-	args.read_write = read_write;
-	args.command = command;
-	args.size = size;
-	args.data = data;
-
-	err = ioctl(file, I2C_SMBUS, &args);
-	if (err == -1)
-		err = -errno;
-	return err;
-}
-
 //------------------------------------------------------------------------------
 __s32 get_net_info (__s8 *eth_name, __u8 *my_ip, __s32 *speed, __u8 *mac)
 {
@@ -184,6 +196,92 @@ __s32 mac_range_check (app_data_t *app_data, __u8 *mac)
 	return 1;
 }
 
+//------------------------------------------------------------------------------
+static __u32 app_usec (void)
+{
+	struct timespec ts;
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	return (__u32)(ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+//------------------------------------------------------------------------------
+/* latency 표시 (ns -> "850us", "1.25ms", 유효숫자 3~4자리) */
+static void app_ns_str (__u32 ns, char *buf, int size)
+{
+	__u32 u = ns / 1000;
+
+	if (u < 1000)
+		snprintf (buf, size, "%uus", u);
+	else if (u < 1000000)
+		snprintf (buf, size, "%u.%02ums", u / 1000, (u % 1000) / 10);
+	else
+		snprintf (buf, size, "%u.%02us", u / 1000000, (u % 1000000) / 10000);
+}
+
+//------------------------------------------------------------------------------
+/* 시간과 함께 LOG widget에 한 줄을 추가한다. */
+static void app_log (app_data_t *app_data, const char *fmt, ...)
+{
+	char buf[ITEM_STR_MAX];
+	time_t t = time(NULL);
+	struct tm tm;
+	va_list va;
+
+	localtime_r (&t, &tm);
+	va_start (va, fmt);	vsnprintf (buf, sizeof(buf), fmt, va);	va_end (va);
+	ui_log (app_data->pfb, app_data->pui, APP_LOG_ID, "%02d:%02d:%02d %s",
+			tm.tm_hour, tm.tm_min, tm.tm_sec, buf);
+}
+
+//------------------------------------------------------------------------------
+/*
+	pass/fail 상태를 박스 색으로 표시하고 상태가 바뀐 경우 log에 남긴다.
+	(처음 검사시에는 fail인 경우만 남김)
+*/
+static void app_set_pass (app_data_t *app_data, ui_bind_t *bind, bool pass,
+							const char *fmt, ...)
+{
+	char buf[ITEM_STR_MAX];
+	va_list va;
+
+	if (bind->valid ? (bind->v.pass != pass) : !pass) {
+		va_start (va, fmt);	vsnprintf (buf, sizeof(buf), fmt, va);	va_end (va);
+		app_log (app_data, "%s %s", buf, pass ? "OK" : "FAIL");
+	}
+	ui_bind_pass (app_data->pfb, app_data->pui, bind, pass);
+}
+
+//------------------------------------------------------------------------------
+/* link 속도가 바뀐 경우 log에 남긴다. (link up/down 포함) */
+static void app_check_link (app_data_t *app_data, int ch, int speed)
+{
+	if (speed == app_data->link_speed[ch])
+		return;
+	app_log (app_data, "%s link %s (%d MB/s)", app_data->eth_name[ch],
+			speed ? "up" : "down", speed);
+	app_data->link_speed[ch] = speed;
+}
+
+//------------------------------------------------------------------------------
+/* n 번째 검사 대상의 박스 id (화면에 박스가 없으면 -1) */
+static int app_ui_id (int base, int n)
+{
+	return (n < APP_UI_TARGETS) ? base + n : -1;
+}
+
+//------------------------------------------------------------------------------
+/* 주소 목록 문자열 ("0x29 0x50", 길면 뒷부분 생략) */
+static void app_addr_str (i2c_map_t *map, char *buf, int size)
+{
+	int addr, len = 0;
+
+	buf[0] = 0x00;
+	for (addr = 0; (addr < I2C_ADDR_MAX) && (len < size); addr++)
+		if (I2C_MAP_TEST(map, addr))
+			len += snprintf (buf + len, size - len, len ? " 0x%02x" : "0x%02x", addr);
+}
+
 //------------------------------------------------------------------------------
 //__s32 get_net_info (char *eth_name, char *my_ip, int *speed, char *mac)
 void app_test_net (app_data_t *app_data)
@@ -193,77 +291,189 @@ void app_test_net (app_data_t *app_data)
 
 	memset (ip, 0, sizeof(ip));	memset (mac, 0, sizeof(mac));	speed = 0;
 	get_net_info (app_data->eth_name[0], ip, &speed, mac);
+	app_check_link (app_data, 0, speed);
 //	ui_set_ritem(app_data->pfb, app_data->pui, 6, COLOR_GREEN, -1);
 	ui_set_str (app_data->pfb, app_data->pui, 6, -1, -1,
 				3, -1, "%s(%s), %d MB/s",
 				app_data->eth_name[0], ip, speed);
 
 	// MAC0 Address Check
-	ui_set_str (app_data->pfb, app_data->pui, 8, -1, -1,
-				3, -1, "MAC(%s) : %02x:%02x:%02x:%02x:%02x:%02x",
-				app_data->eth_name[0], mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
+	ui_bind_mac (app_data->pfb, app_data->pui, &app_data->b_mac[0], mac);
 	if (mac_range_check(app_data, ip))
-		ui_set_ritem(app_data->pfb, app_data->pui, 8, COLOR_RED, -1);
+		app_set_pass(app_data, &app_data->b_mac_pass[0], false,
+				"MAC(%s) range", app_data->eth_name[0]);
 	else
-		ui_set_ritem(app_data->pfb, app_data->pui, 8, COLOR_GREEN, -1);
+		app_set_pass(app_data, &app_data->b_mac_pass[0], true,
+				"MAC(%s) range", app_data->eth_name[0]);
 
 	memset (ip, 0, sizeof(ip));	memset (mac, 0, sizeof(mac));	speed = 0;
 	get_net_info (app_data->eth_name[1], ip, &speed, mac);
+	app_check_link (app_data, 1, speed);
 //	ui_set_ritem(app_data->pfb, app_data->pui, 7, COLOR_GREEN, -1);
 	ui_set_str (app_data->pfb, app_data->pui, 7, -1, -1,
 				3, -1, "%s(%s), %d MB/s",
 				app_data->eth_name[1], ip, speed);
 
 	// MAC1 Address Check
-	ui_set_str (app_data->pfb, app_data->pui, 9, -1, -1,
-				3, -1, "MAC(%s) : %02x:%02x:%02x:%02x:%02x:%02x",
-				app_data->eth_name[1], mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
+	ui_bind_mac (app_data->pfb, app_data->pui, &app_data->b_mac[1], mac);
 	if (mac_range_check(app_data, ip))
-		ui_set_ritem(app_data->pfb, app_data->pui, 9, COLOR_RED, -1);
+		app_set_pass(app_data, &app_data->b_mac_pass[1], false,
+				"MAC(%s) range", app_data->eth_name[1]);
 	else
-		ui_set_ritem(app_data->pfb, app_data->pui, 9, COLOR_GREEN, -1);
+		app_set_pass(app_data, &app_data->b_mac_pass[1], true,
+				"MAC(%s) range", app_data->eth_name[1]);
 }
 
 //------------------------------------------------------------------------------
 void app_test_i2c (app_data_t *app_data)
 {
-	int fd, i;
-
-	for (i = 0; i < 2; i++) {
-		ui_set_str (app_data->pfb, app_data->pui, i + 2, -1, -1,
-					3, -1, "Found I2C Node(%s)", app_data->i2c_node_name[i]);
-		if (access (app_data->i2c_node_name[i], F_OK) != 0) {
-			ui_set_ritem(app_data->pfb, app_data->pui, i + 2, COLOR_RED, -1);
+	int i, addr, errs = 0;
+	bool pass;
+	char addr_str[ITEM_STR_MAX];
+	i2c_bus_t *bus;
+	i2c_target_t *t;
+	i2c_lat_t lat, *plat;
+	__u32 xfer;
+
+	for (i = 0; i < app_data->target_cnt; i++) {
+		t = &app_data->target[i];
+		ui_set_str (app_data->pfb, app_data->pui, t->b_node.id, -1, -1,
+					3, -1, "Found I2C Node(%s)", t->node);
+		/* adapter는 처음 한번만 open 하여 계속 사용한다. (lib_i2c) */
+		if ((bus = i2c_bus_open (t->node)) == NULL) {
+			app_set_pass(app_data, &t->b_node, false, "%s node", t->node);
+			errs++;
+			continue;
 		}
-		else {
-			ui_set_ritem(app_data->pfb, app_data->pui, i + 2, COLOR_GREEN, -1);
-			ui_set_str (app_data->pfb, app_data->pui, i + 4, -1, -1,
-						3, -1, "Check %s Device (Addr = 0x%02x)",
-						app_data->i2c_node_name[i],
-						app_data->i2c_test_addr[i]);
-
-			if ((fd = open(app_data->i2c_node_name[i], O_RDWR)) < 0) {
-				ui_set_ritem(app_data->pfb, app_data->pui, i + 4, COLOR_RED, -1);
-			} else {
-				// set the I2C slave address for all subsequent I2C device transfers
-				if (ioctl(fd, I2C_SLAVE, app_data->i2c_test_addr[i]) < 0) {
-					err("Error failed to set I2C address [0x%02x].\n",
-						app_data->i2c_test_addr[i]);
-					ui_set_ritem(app_data->pfb, app_data->pui, i + 4, COLOR_RED, -1);
-				} else {
-					union i2c_smbus_data data;
-					int err;
-
-					err = i2c_smbus_access(fd, I2C_SMBUS_READ, 0, I2C_SMBUS_BYTE, &data);
-					if (err)
-						ui_set_ritem(app_data->pfb, app_data->pui, i + 4, COLOR_RED, -1);
-					else
-						ui_set_ritem(app_data->pfb, app_data->pui, i + 4, COLOR_GREEN, -1);
-				}
-				close(fd);
+		app_set_pass(app_data, &t->b_node, true, "%s node", t->node);
+
+		app_addr_str (&t->addr, addr_str, sizeof(addr_str));
+		memset (&lat, 0x00, sizeof(lat));
+
+		for (addr = 0, pass = true; addr < I2C_ADDR_MAX; addr++) {
+			if (!I2C_MAP_TEST(&t->addr, addr))
+				continue;
+			plat = i2c_bus_lat (bus, addr, eI2C_OP_READ_BYTE);
+			xfer = plat ? plat->cnt : 0;
+
+			// set the I2C slave address (주소가 바뀐 경우에만 ioctl)
+			if (!i2c_bus_select (bus, addr)) {
+				err ("%s : failed to set I2C address [0x%02x].\n", t->node, addr);
+				pass = false;
+			}
+			else if (i2c_bus_read_byte (bus, addr) < 0)
+				pass = false;
+			if (plat == NULL)
+				continue;
+
+			/* 전송 응답 시간 (lib_i2c에서 측정, 실패한 전송 포함) */
+			if (plat->cnt != xfer) {
+				ui_sample (app_data->pfb, app_data->pui, APP_LAT_ID,  bus->last_ns / 1000);
+				ui_sample (app_data->pfb, app_data->pui, APP_HIST_ID, bus->last_ns / 1000);
 			}
+			/* 검사 주소들의 전송 latency 누적 (adapter를 연 이후 전체) */
+			i2c_lat_merge (&lat, plat);
+		}
+		if (lat.cnt) {
+			char p50[16], p99[16], max[16];
+
+			app_ns_str (i2c_lat_pct (&lat, 50), p50, sizeof(p50));
+			app_ns_str (i2c_lat_pct (&lat, 99), p99, sizeof(p99));
+			app_ns_str (lat.max, max, sizeof(max));
+			ui_set_str (app_data->pfb, app_data->pui, t->b_dev.id, -1, -1,
+						-1, -1, "%s p50 %s p99 %s max %s", addr_str, p50, p99, max);
+		} else
+			ui_set_str (app_data->pfb, app_data->pui, t->b_dev.id, -1, -1,
+						3, -1, "Check %s Device (Addr = %s)", t->node, addr_str);
+		app_set_pass(app_data, &t->b_dev, pass, "%s %s", t->node, addr_str);
+		if (!pass)
+			errs++;
+	}
+	/* 이번 검사에서 실패한 항목 수 */
+	ui_sample (app_data->pfb, app_data->pui, APP_ERR_ID, errs);
+}
+
+//------------------------------------------------------------------------------
+/*
+	scan mode
+	모든 adapter의 0x03 ~ 0x77 주소를 동시에 scan 하여 있어야 하는 device(검사 주소)와
+	비교한 결과를 GRID widget에 표시한다. 이전 scan과 달라진 주소는 log에 남긴다.
+*/
+void app_scan_i2c (app_data_t *app_data)
+{
+	int			cnt = app_data->target_cnt, *found, i, addr, color, missing, extra;
+	i2c_bus_t	**bus;
+	i2c_map_t	*map;
+	i2c_target_t *t;
+	bool		is, expect;
+	__u32		usec;
+
+	bus   = (i2c_bus_t **)calloc (cnt, sizeof(i2c_bus_t *));
+	map   = (i2c_map_t  *)calloc (cnt, sizeof(i2c_map_t));
+	found = (int *)calloc (cnt, sizeof(int));
+	if (!bus || !map || !found)
+		goto out;
+
+	for (i = 0; i < cnt; i++)
+		bus[i] = i2c_bus_open (app_data->target[i].node);
+
+	usec = app_usec();
+	i2c_scan (bus, cnt, map, found);
+	usec = app_usec() - usec;
+
+	for (i = 0; i < cnt; i++) {
+		t = &app_data->target[i];
+		for (addr = I2C_SCAN_FIRST, missing = extra = 0; addr <= I2C_SCAN_LAST; addr++) {
+			is     = I2C_MAP_TEST(&map[i], addr);
+			expect = I2C_MAP_TEST(&t->addr, addr);
+
+			if      (is && expect)	color = SCAN_COLOR_OK;
+			else if (expect)	{	color = SCAN_COLOR_MISSING;	missing++;	}
+			else if (is)		{	color = SCAN_COLOR_EXTRA;	extra++;	}
+			else					color = SCAN_COLOR_EMPTY;
+			ui_cell (app_data->pfb, app_data->pui, app_ui_id (APP_GRID_ID, i), addr, color);
+
+			if ((found[i] >= 0) && (is != I2C_MAP_TEST(&t->found, addr)))
+				app_log (app_data, "%s 0x%02x %s", t->node, addr, is ? "found" : "lost");
 		}
+		t->found = map[i];
+
+		if (found[i] < 0)
+			ui_set_str (app_data->pfb, app_data->pui, app_ui_id (APP_SCAN_ID, i), -1, -1,
+						-1, -1, "%s not found", t->node);
+		else
+			ui_set_str (app_data->pfb, app_data->pui, app_ui_id (APP_SCAN_ID, i), -1, -1,
+						-1, -1, "%s : %d dev, %d miss, %d extra",
+						t->node, found[i], missing, extra);
+		ui_set_ritem (app_data->pfb, app_data->pui, app_ui_id (APP_SCAN_ID, i),
+					((found[i] < 0) || missing || extra) ? COLOR_RED : COLOR_GREEN, -1);
 	}
+	ui_bind_usec (app_data->pfb, app_data->pui, &app_data->b_scan_time, usec);
+out:
+	free (bus);	free (map);	free (found);
+}
+
+//------------------------------------------------------------------------------
+/*
+	값이 바뀐 경우에만 다시 그려지는 item 설정
+	(eth_name이 fmt에 포함되므로 app config가 바뀌면 다시 호출)
+*/
+void app_bind_init (app_data_t *app_data)
+{
+	char fmt[ITEM_STR_MAX];
+	int i;
+
+	for (i = 0; i < 2; i++) {
+		snprintf (fmt, sizeof(fmt), "MAC(%s) : %%s", app_data->eth_name[i]);
+		ui_bind (&app_data->b_mac[i],      i + 8, eBIND_MAC,  3, fmt);
+		ui_bind (&app_data->b_mac_pass[i], i + 8, eBIND_PASS, 3, NULL);
+	}
+	/* 검사 대상이 화면의 박스 수보다 많으면 나머지는 log에만 남긴다. */
+	for (i = 0; i < app_data->target_cnt; i++) {
+		ui_bind (&app_data->target[i].b_node, app_ui_id (2, i), eBIND_PASS, 3, NULL);
+		ui_bind (&app_data->target[i].b_dev,  app_ui_id (4, i), eBIND_PASS, 3, NULL);
+	}
+	ui_bind (&app_data->b_scan_time, APP_SCAN_TIME_ID, eBIND_LATENCY, -1, "scan %s");
 }
 
 //------------------------------------------------------------------------------
@@ -277,16 +487,401 @@ void app_info_display (app_data_t *app_data)
     ui_set_str (app_data->pfb, app_data->pui, 1, -1, -1,
                 3, -1, "%d/%d/%d, %02d:%02d:%02d",
 				tm.tm_year + 1900, tm.tm_mon, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec);
+	if (app_data->scan_mode) {
+		app_scan_i2c (app_data);
+		return;
+	}
 	app_test_i2c (app_data);
 	app_test_net (app_data);
 }
 
 //------------------------------------------------------------------------------
+/*
+	Config hot reload
+	ui/app/overlay config 파일이 있는 디렉토리를 inotify로 감시한다.
+	(편집기는 보통 새 파일에 쓴 후 rename 하므로 파일이 아닌 디렉토리를 감시)
+	파일이 바뀌면 감시 thread에서 새로 읽어 pending 포인터로 넘기고
+	app_main의 화면 갱신 사이에 교체한다.
+*/
+//------------------------------------------------------------------------------
+#define	WATCH_SETTLE_MS		200
+
+enum { eWATCH_UI, eWATCH_APP, eWATCH_OVERLAY, eWATCH_END };
+
+//------------------------------------------------------------------------------
+/* parse_cfg_file로 만든 app_data (검사 대상 목록 포함) 해제 */
+static void app_data_free (app_data_t *papp)
+{
+	if (papp != NULL) {
+		free (papp->target);
+		free (papp);
+	}
+}
+
+//------------------------------------------------------------------------------
+/*
+	검사 대상 목록 교체
+	같은 adapter의 마지막 scan 결과는 유지하여 found/lost log가 다시 나오지 않도록 하고,
+	열려있는 handle(latency histogram 포함)도 그대로 사용한다.
+	검사 대상에서 빠진 adapter의 handle만 닫는다.
+*/
+static void app_target_swap (app_data_t *app_data, app_data_t *papp)
+{
+	int i, j;
+
+	for (j = 0; j < app_data->target_cnt; j++) {
+		for (i = 0; i < papp->target_cnt; i++) {
+			if (!strncmp (papp->target[i].node, app_data->target[j].node,
+							sizeof(papp->target[i].node))) {
+				papp->target[i].found = app_data->target[j].found;
+				break;
+			}
+		}
+		if (i == papp->target_cnt)
+			i2c_bus_remove (app_data->target[j].node);
+	}
+	free (app_data->target);
+	app_data->target     = papp->target;
+	app_data->target_cnt = papp->target_cnt;
+	papp->target     = NULL;
+	papp->target_cnt = 0;
+}
+
+//------------------------------------------------------------------------------
+static void app_watch_reload (app_data_t *app_data, int changed)
+{
+	if (changed & (1 << eWATCH_UI)) {
+		ui_grp_t *pui = ui_load (app_data->pfb, app_data->ui_cfg_file);
+
+		if (pui == NULL)
+			err ("%s reload fail! keep current ui.\n", app_data->ui_cfg_file);
+		/* 아직 적용되지 않은 이전 설정이 있다면 버린다. */
+		else if ((pui = __atomic_exchange_n (&app_data->pui_pending, pui,
+											__ATOMIC_ACQ_REL)) != NULL)
+			ui_close (pui);
+	}
+	if (changed & ((1 << eWATCH_APP) | (1 << eWATCH_OVERLAY))) {
+		app_data_t *papp = (app_data_t *)calloc (1, sizeof(app_data_t));
+
+		if ((papp == NULL) || !parse_cfg_file ((char *)app_data->app_cfg_file, papp)) {
+			err ("%s reload fail! keep current config.\n", app_data->app_cfg_file);
+			app_data_free (papp);
+		}
+		else
+			app_data_free (__atomic_exchange_n (&app_data->papp_pending, papp,
+												__ATOMIC_ACQ_REL));
+	}
+}
+
+//------------------------------------------------------------------------------
+static void *app_watch_thread (void *arg)
+{
+	app_data_t *app_data = (app_data_t *)arg;
+	const char *files[eWATCH_END];
+	char names[eWATCH_END][NAME_MAX + 1], tmp[PATH_MAX];
+	char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+	struct inotify_event *ev;
+	struct pollfd pfd;
+	int wd[eWATCH_END], fd, i, changed;
+	ssize_t len;
+	char *p;
+
+	files[eWATCH_UI]      = app_data->ui_cfg_file;
+	files[eWATCH_APP]     = app_data->app_cfg_file;
+	files[eWATCH_OVERLAY] = OVERLAY_CFG_FILE;
+
+	if ((fd = inotify_init1 (IN_CLOEXEC)) < 0) {
+		err ("inotify init fail! (%s)\n", strerror(errno));
+		return NULL;
+	}
+	for (i = 0; i < eWATCH_END; i++) {
+		snprintf (tmp, sizeof(tmp), "%s", files[i]);
+		snprintf (names[i], sizeof(names[i]), "%s", basename(tmp));
+		snprintf (tmp, sizeof(tmp), "%s", files[i]);
+		/* 같은 디렉토리는 같은 watch descriptor가 반환됨 */
+		wd[i] = inotify_add_watch (fd, dirname(tmp),
+						IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE);
+		if (wd[i] < 0) {
+			err ("%s : watch fail, hot reload disabled (%s)\n", files[i], strerror(errno));
+		}
+	}
+
+	pfd.fd = fd;	pfd.events = POLLIN;
+	while (1) {
+		/*
+			첫 이벤트까지 기다린 후, 편집기가 여러번 나누어 쓰는 경우를 위해
+			WATCH_SETTLE_MS 동안 이벤트가 없을 때까지 모아서 처리한다.
+		*/
+		changed = 0;
+		while (poll (&pfd, 1, changed ? WATCH_SETTLE_MS : -1) > 0) {
+			if ((len = read (fd, buf, sizeof(buf))) <= 0)
+				break;
+			for (p = buf; p < buf + len; p += sizeof(struct inotify_event) + ev->len) {
+				ev = (struct inotify_event *)p;
+				for (i = 0; i < eWATCH_END; i++)
+					if ((ev->wd == wd[i]) && ev->len && !strcmp (ev->name, names[i]))
+						changed |= (1 << i);
+			}
+		}
+		if (changed)
+			app_watch_reload (app_data, changed);
+	}
+	return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void app_reload (app_data_t *app_data)
+{
+	ui_grp_t	*pui;
+	app_data_t	*papp;
+
+	/* 바뀐 박스와 문자열만 다시 그려지도록 현재 화면과 비교 후 교체 */
+	if ((pui = __atomic_exchange_n (&app_data->pui_pending, NULL,
+									__ATOMIC_ACQ_REL)) != NULL) {
+		ui_swap  (app_data->pfb, app_data->pui, pui);
+		ui_close (app_data->pui);
+		app_data->pui = pui;
+		info ("UI config reloaded. (%s)\n", app_data->ui_cfg_file);
+	}
+
+	/* 검사 대상 설정만 교체 (FB device 변경은 재시작 후 적용) */
+	if ((papp = __atomic_exchange_n (&app_data->papp_pending, NULL,
+									__ATOMIC_ACQ_REL)) != NULL) {
+		memcpy (app_data->model,         papp->model,         sizeof(papp->model));
+		app_target_swap (app_data, papp);
+		memcpy (app_data->eth_name,      papp->eth_name,      sizeof(papp->eth_name));
+		memcpy (app_data->mac_test,      papp->mac_test,      sizeof(papp->mac_test));
+		memcpy (app_data->mac_range,     papp->mac_range,     sizeof(papp->mac_range));
+		memcpy (app_data->soak_mix,      papp->soak_mix,      sizeof(papp->soak_mix));
+		app_data->soak_block_len = papp->soak_block_len;
+		app_data_free (papp);
+		app_bind_init (app_data);
+		info ("APP config reloaded. (%s)\n", app_data->app_cfg_file);
+	}
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
+/*
+	soak mode (--soak {sec})
+	검사 대상 adapter 마다 thread가 검사 주소의 device들에 쉬지 않고 전송한다.
+	화면은 1초 마다 thread의 결과를 잠금 없이 읽어 표시하므로 전송을 늦추지 않는다.
+	(설정 hot reload는 하지 않음 : thread가 사용중인 bus handle을 닫을 수 없으므로)
+*/
+typedef struct app_soak__t {
+	i2c_soak_t	s;
+	/* 마지막으로 화면에 표시한 값 (1초 동안의 변화량 계산) */
+	__u64		xfer, bytes, errs;
+	__u32		err[I2C_SOAK_ERRNO_MAX];
+	i2c_lat_t	lat;
+}	app_soak_t;
+
+//------------------------------------------------------------------------------
+/* 검사 주소 전체의 전송 latency (op < 0 이면 모든 전송 종류) */
+static void app_soak_lat (app_soak_t *soak, int op, i2c_lat_t *lat)
+{
+	int addr, i;
+	i2c_lat_t *plat;
+
+	memset (lat, 0x00, sizeof(i2c_lat_t));
+	for (addr = 0; addr < I2C_ADDR_MAX; addr++) {
+		if (!I2C_MAP_TEST(&soak->s.addr, addr))
+			continue;
+		for (i = 0; i < eI2C_OP_END; i++)
+			if (((op < 0) || (op == i)) &&
+				((plat = i2c_bus_lat (soak->s.bus, addr, i)) != NULL))
+				i2c_lat_merge (lat, plat);
+	}
+}
+
+//------------------------------------------------------------------------------
+static void app_soak_display (app_data_t *app_data, app_soak_t *soak,
+								int sec, __u32 usec)
+{
+	int i, e;
+	__u64 xfer, bytes, errs, fails = 0;
+	__u32 cnt;
+	i2c_lat_t lat, sec_lat;
+	char p50[16], p99[16], max[16];
+	i2c_target_t *t;
+
+	ui_set_str (app_data->pfb, app_data->pui, 0, -1, -1,
+				4, -1, "ODROID-H3 I2C Soak Test");
+	ui_set_str (app_data->pfb, app_data->pui, 1, -1, -1,
+				3, -1, "SOAK %d / %d sec", sec, app_data->soak_sec);
+	if (usec == 0)
+		usec = 1;
+	memset (&sec_lat, 0x00, sizeof(sec_lat));
+
+	for (i = 0; i < app_data->target_cnt; i++) {
+		t = &app_data->target[i];
+		xfer  = __atomic_load_n (&soak[i].s.xfer,  __ATOMIC_RELAXED);
+		bytes = __atomic_load_n (&soak[i].s.bytes, __ATOMIC_RELAXED);
+		errs  = __atomic_load_n (&soak[i].s.errs,  __ATOMIC_RELAXED);
+
+		ui_set_str (app_data->pfb, app_data->pui, t->b_node.id, -1, -1,
+					-1, -1, "%s %llu xfer/s %llu B/s", t->node,
+					(xfer - soak[i].xfer) * 1000000 / usec,
+					(bytes - soak[i].bytes) * 1000000 / usec);
+		app_set_pass (app_data, &t->b_node, soak[i].s.run, "%s soak thread", t->node);
+
+		app_soak_lat (&soak[i], -1, &lat);
+		app_ns_str (i2c_lat_pct (&lat, 50), p50, sizeof(p50));
+		app_ns_str (i2c_lat_pct (&lat, 99), p99, sizeof(p99));
+		app_ns_str (lat.max, max, sizeof(max));
+		ui_set_str (app_data->pfb, app_data->pui, t->b_dev.id, -1, -1,
+					-1, -1, "p50 %s p99 %s max %s err %llu", p50, p99, max, errs);
+
+		/* 지난 1초 동안의 histogram (누적값의 차이, max는 전체 최대값) */
+		for (e = 0; e < I2C_LAT_BUCKETS; e++)
+			sec_lat.bucket[e] += lat.bucket[e] - soak[i].lat.bucket[e];
+		sec_lat.cnt += lat.cnt - soak[i].lat.cnt;
+		if (lat.max > sec_lat.max)
+			sec_lat.max = lat.max;
+		soak[i].lat = lat;
+		app_set_pass (app_data, &t->b_dev, !errs, "%s soak", t->node);
+
+		/* 새로 생긴 errno 별 실패 수 */
+		for (e = 0; e < I2C_SOAK_ERRNO_MAX; e++) {
+			cnt = __atomic_load_n (&soak[i].s.err[e], __ATOMIC_RELAXED);
+			if (cnt != soak[i].err[e])
+				app_log (app_data, "%s %s +%u", t->node, strerror(e), cnt - soak[i].err[e]);
+			soak[i].err[e] = cnt;
+		}
+		fails += errs - soak[i].errs;
+		soak[i].xfer = xfer;	soak[i].bytes = bytes;	soak[i].errs = errs;
+	}
+	/* 전체 adapter의 지난 1초 p99 (usec) 및 실패한 전송 수 */
+	if (sec_lat.cnt) {
+		ui_sample (app_data->pfb, app_data->pui, APP_LAT_ID,  i2c_lat_pct (&sec_lat, 99) / 1000);
+		ui_sample (app_data->pfb, app_data->pui, APP_HIST_ID, i2c_lat_pct (&sec_lat, 99) / 1000);
+	}
+	ui_sample (app_data->pfb, app_data->pui, APP_ERR_ID,  (int)fails);
+}
+
+//------------------------------------------------------------------------------
+/* adapter 별 최종 결과 출력 */
+static void app_soak_report (app_data_t *app_data, app_soak_t *soak, int sec)
+{
+	int i, e, op;
+	i2c_lat_t lat;
+	char p50[16], p99[16], max[16];
+
+	if (sec <= 0)
+		sec = 1;
+	printf("========== I2C SOAK RESULT (%d sec) ==========\n", sec);
+	for (i = 0; i < app_data->target_cnt; i++) {
+		i2c_soak_t *s = &soak[i].s;
+
+		printf("%s (%s)%s\n", app_data->target[i].node, app_data->target[i].name,
+				s->bus ? "" : " : open fail, not tested");
+		printf("    %llu xfer (%llu/s), %llu bytes (%llu B/s), %llu errors\n",
+				s->xfer, s->xfer / sec, s->bytes, s->bytes / sec, s->errs);
+		for (e = 0; e < I2C_SOAK_ERRNO_MAX; e++)
+			if (s->err[e])
+				printf("    error %s (%d) : %u\n", strerror(e), e, s->err[e]);
+		for (op = 0; s->bus && (op < eI2C_OP_END); op++) {
+			app_soak_lat (&soak[i], op, &lat);
+			if (!lat.cnt)
+				continue;
+			app_ns_str (i2c_lat_pct (&lat, 50), p50, sizeof(p50));
+			app_ns_str (i2c_lat_pct (&lat, 99), p99, sizeof(p99));
+			app_ns_str (lat.max, max, sizeof(max));
+			printf("    %-10s %u xfer, p50 %s, p99 %s, max %s\n",
+					i2c_op_name(op), lat.cnt, p50, p99, max);
+		}
+	}
+	printf("==============================================\n");
+}
+
+//------------------------------------------------------------------------------
+/* 실패한 전송이 없으면 0, 있으면 1 */
+static int app_soak (app_data_t *app_data)
+{
+	app_soak_t *soak;
+	struct timespec ts;
+	time_t start;
+	int i, sec = 0, ret = 0;
+	__u32 usec;
+
+	if ((soak = (app_soak_t *)calloc (app_data->target_cnt, sizeof(app_soak_t))) == NULL) {
+		err ("soak alloc fail!\n");
+		return 1;
+	}
+	app_bind_init (app_data);
+	/* 검사할 adapter가 없으면 전송 없이 끝나므로 실패 */
+	if (!app_data->target_cnt) {
+		app_log (app_data, "SOAK no i2c adapter");
+		ret = 1;
+	}
+	for (i = 0; i < app_data->target_cnt; i++) {
+		i2c_soak_t *s = &soak[i].s;
+
+		s->bus  = i2c_bus_open (app_data->target[i].node);
+		s->addr = app_data->target[i].addr;
+		memcpy (s->mix, app_data->soak_mix, sizeof(s->mix));
+		s->block_len = app_data->soak_block_len;
+		if (!i2c_soak_start (s))
+			app_log (app_data, "%s soak start fail", app_data->target[i].node);
+	}
+
+	clock_gettime (CLOCK_MONOTONIC, &ts);
+	start = ts.tv_sec;
+	usec  = app_usec ();
+	while (sec < app_data->soak_sec) {
+		sleep (1);
+		clock_gettime (CLOCK_MONOTONIC, &ts);
+		sec = ts.tv_sec - start;
+
+		app_soak_display (app_data, soak, sec, app_usec () - usec);
+		usec = app_usec ();
+		ui_flush (app_data->pfb, app_data->pui);
+		fb_flush (app_data->pfb);
+		if (app_data->lat_file != NULL)
+			i2c_lat_export (app_data->lat_file);
+	}
+
+	for (i = 0; i < app_data->target_cnt; i++) {
+		i2c_soak_stop (&soak[i].s);
+		/* 시작하지 못했거나 전송이 하나도 없었던 adapter는 실패 */
+		if (!soak[i].s.bus || !soak[i].s.xfer || soak[i].s.errs)
+			ret = 1;
+	}
+	app_log (app_data, "SOAK %s", ret ? "FAIL" : "PASS");
+	ui_flush (app_data->pfb, app_data->pui);
+	fb_flush (app_data->pfb);
+	if (app_data->lat_file != NULL)
+		i2c_lat_export (app_data->lat_file);
+
+	app_soak_report (app_data, soak, sec);
+	free (soak);
+	return ret;
+}
+
 //------------------------------------------------------------------------------
 int app_main (app_data_t *app_data)
 {
+	pthread_t	watch;
+
+	if (app_data->soak_sec > 0)
+		return app_soak (app_data);
+
+	/* config 파일 변경 감시 */
+	if (pthread_create (&watch, NULL, app_watch_thread, app_data) == 0)
+		pthread_detach (watch);
+	else
+		err ("config watch thread create fail!\n");
+
+	app_bind_init (app_data);
 	while (1) {
+		app_reload (app_data);
 		app_info_display(app_data);
+		/* 바뀐 item만 다시 그린 후 화면에 반영 */
+		ui_flush(app_data->pfb, app_data->pui);
+		fb_flush(app_data->pfb);
+		/* 전송 latency histogram 저장 (-l) */
+		if (app_data->lat_file != NULL)
+			i2c_lat_export (app_data->lat_file);
 		sleep(1);
 	}
 	return 0;
@@ -16,17 +16,42 @@
 
 #include <unistd.h>
 #include <sys/time.h>
+//-----------------------------------------------------------------------------
+#define	OVERLAY_CFG_FILE	"/root/OverlayConfig/overlay_app.cfg"
+
+//-----------------------------------------------------------------------------
+/*
+	검사 대상 adapter (app config의 I2C 설정과 이름이 맞는 adapter 마다 1개)
+*/
+typedef struct i2c_target__t {
+	/* /dev/i2c-N, sysfs adapter 이름 */
+	char		node[32];
+	char		name[64];
+	/* 검사할 device 주소 (scan mode : 있어야 하는 device) */
+	i2c_map_t	addr;
+	/* scan mode : 마지막 scan 결과 */
+	i2c_map_t	found;
+	/* 화면에 박스가 없는 대상은 id = -1 (log만 남김) */
+	ui_bind_t	b_node, b_dev;
+}	i2c_target_t;
+
 //-----------------------------------------------------------------------------
 typedef struct app_data__t {
 	/* build info */
 	char		bdate[32], btime[32];
 	/* JIG model name */
 	char		model[32];
-	/* I2C dev node */
-	char		i2c_node_name[2][32];
-	__u8		i2c_test_addr[2];
+	/* I2C 검사 대상 table (parse_cfg_file에서 찾은 adapter 수 만큼 할당) */
+	i2c_target_t	*target;
+	int				target_cnt;
+	/* scan mode : 모든 주소를 scan 하여 검사 대상의 주소와 비교 */
+	bool		scan_mode;
+	/* soak mode 시간(초, 0 = 사용 안함), 전송 종류별 비율, block read 크기 */
+	int			soak_sec;
+	int			soak_mix[eI2C_OP_END];
+	int			soak_block_len;
 	/* FB dev node */
-	char		fb_dev[32];
+	char		fb_dev[128];
 	/* ethernet name(mac) */
 	char		eth_name[2][32];
 	char		mac_test[16];
@@ -35,9 +60,25 @@ typedef struct app_data__t {
 	fb_info_t	*pfb;
 	ui_grp_t	*pui;
 
+	/* 값이 바뀔 때만 다시 그리는 item (app_bind_init) */
+	ui_bind_t	b_mac[2], b_mac_pass[2];
+	ui_bind_t	b_scan_time;
+	/* 마지막으로 확인한 link 속도 (변경시 log) */
+	int			link_speed[2];
+
+	/* config file (hot reload 감시 대상) */
+	const char	*ui_cfg_file, *app_cfg_file;
+	/* 전송 latency histogram 저장 파일 (NULL = 저장하지 않음) */
+	const char	*lat_file;
+
+	/* hot reload : 감시 thread에서 새로 읽은 설정 (app_main에서 교체) */
+	ui_grp_t			*pui_pending;
+	struct app_data__t	*papp_pending;
+
 }	app_data_t;
 
 //------------------------------------------------------------------------------
+extern  bool parse_cfg_file (char *cfg_filename, app_data_t *app_data);
 extern  int app_main (app_data_t *app_data);
 
 //------------------------------------------------------------------------------
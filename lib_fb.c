@@ -25,6 +25,10 @@
 #include <sys/mman.h>
 #include <linux/fb.h>
 #include <getopt.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FB_USE_SIMD
+#endif
 
 #include "lib_fb.h"
 //-----------------------------------------------------------------------------
@@ -45,32 +49,64 @@
 static void make_image  (unsigned char is_first,
                         unsigned char *dest,
                         unsigned char *src);
-static unsigned char *get_hangul_image( unsigned char HAN1,
-                                        unsigned char HAN2,
-                                        unsigned char HAN3);
-static void draw_hangul_bitmap (fb_info_t *fb,
-                    int x, int y, unsigned char *p_img,
-                    int f_color, int b_color, int scale);
-static void draw_ascii_bitmap (fb_info_t *fb,
-                    int x, int y, unsigned char *p_img,
+static const unsigned char *get_hangul_image(unsigned int utf16);
+static void _fb_draw_char (fb_info_t *fb, int x, int y, unsigned int code,
                     int f_color, int b_color, int scale);
 static void _draw_text (fb_info_t *fb, int x, int y, char *p_str,
                         int f_color, int b_color, int scale);
+static void _fb_draw_glyph (fb_info_t *fb, int x, int y,
+                    const unsigned char *p_img, int row_bytes,
+                    int f_color, int b_color, int scale);
+static const fb_format_t *_fb_find_format (int bpp, bool is_bgr);
+static void _fb_simd_init (void);
+static bool _fb_init_surface (fb_info_t *fb, const char *spec);
+static int          _fb_clip_rect   (fb_info_t *fb, int *x, int *y, int *w, int *h);
+static int          _fb_clip_to     (const fb_rect_t *c, int *x, int *y, int *w, int *h);
+static void         _fb_fill_rect   (fb_info_t *fb, int x, int y, int w, int h, int color);
+static void         _fb_damage      (fb_info_t *fb, int x, int y, int w, int h);
+static void         _put_pixel      (fb_info_t *fb, int x, int y, int color);
 void         put_pixel (fb_info_t *fb, int x, int y, int color);
 void         draw_text (fb_info_t *fb, int x, int y,
                      int f_color, int b_color, int scale, char *fmt, ...);
 void         draw_line (fb_info_t *fb, int x, int y, int w, int color);
 void         draw_rect (fb_info_t *fb, int x, int y, int w, int h, int lw, int color);
 void         draw_fill_rect (fb_info_t *fb, int x, int y, int w, int h, int color);
+void         fb_move_rect (fb_info_t *fb, int sx, int sy, int w, int h, int dx, int dy);
 void         set_font(enum eFONTS_HANGUL s_font);
+unsigned int fb_utf8_decode (const char **p_str);
 void         fb_clear (fb_info_t *fb);
+bool         fb_push_clip (fb_info_t *fb, int x, int y, int w, int h);
+void         fb_pop_clip (fb_info_t *fb);
+void         fb_set_bgr (fb_info_t *fb, bool is_bgr);
+bool         fb_shadow_enable (fb_info_t *fb, bool enable);
+void         fb_flush (fb_info_t *fb);
+void         fb_glyph_cache_size (unsigned long max_bytes);
+void         fb_glyph_cache_stat (unsigned long *hit, unsigned long *miss,
+                                    unsigned long *used);
+bool         fb_dump (fb_info_t *fb, const char *filename);
 void         fb_close (fb_info_t *fb);
 fb_info_t    *fb_init (const char *DEVICE_NAME);
 
 //-----------------------------------------------------------------------------
 // hangul image base 16x16
 //-----------------------------------------------------------------------------
-static unsigned char HANFontImage[32] = {0,};
+#define HANGUL_SYLLABLE_BASE    0xAC00
+#define HANGUL_SYLLABLE_COUNT   11172
+#define HANGUL_IMAGE_SIZE       32
+
+/*
+    폰트별 조합 완료된 한글 image 저장소 (11172 글자, 처음 사용시 할당)
+    각 글자는 처음 그려질 때 한번만 조합되며 이후에는 저장된 image를 사용한다.
+*/
+typedef struct hangul_store__t {
+    unsigned char   valid[(HANGUL_SYLLABLE_COUNT + 7) / 8];
+    unsigned char   image[HANGUL_SYLLABLE_COUNT][HANGUL_IMAGE_SIZE];
+}   hangul_store_t;
+
+static hangul_store_t *HANStore[eFONT_END] = { NULL, };
+
+/* 한글 음절 영역 밖의 문자는 빈 image로 표시 */
+static const unsigned char HANBlankImage[HANGUL_IMAGE_SIZE] = { 0, };
 
 const char D_ML[22] = { 0, 0, 2, 0, 2, 1, 2, 1, 2, 3, 0, 2, 1, 3, 3, 1, 2, 1, 3, 3, 1, 1 																	};
 const char D_FM[40] = { 1, 3, 0, 2, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 1, 3, 0, 2, 1, 3, 1, 3, 1, 3 			};
@@ -79,6 +115,7 @@ const char D_MF[44] = { 0, 0, 0, 5, 0, 5, 0, 5, 0, 5, 0, 5, 0, 5, 0, 5, 0, 5, 1,
 static unsigned char *HANFONT1 = (unsigned char *)FONT_HANGUL1;
 static unsigned char *HANFONT2 = (unsigned char *)FONT_HANGUL2;
 static unsigned char *HANFONT3 = (unsigned char *)FONT_HANGUL3;
+static enum eFONTS_HANGUL HANFONT_TYPE = eFONT_HAN_DEFAULT;
 
 //-----------------------------------------------------------------------------
 //-----------------------------------------------------------------------------
@@ -92,24 +129,32 @@ static void make_image  (unsigned char is_first,
 }
 
 //-----------------------------------------------------------------------------
-static unsigned char *get_hangul_image( unsigned char HAN1,
-                                        unsigned char HAN2,
-                                        unsigned char HAN3)
+static const unsigned char *get_hangul_image(unsigned int utf16)
 {
     unsigned char f, m, l;
     unsigned char f1, f2, f3;
     unsigned char first_flag = 1;
-    unsigned short utf16 = 0;
+    unsigned char *image;
+    hangul_store_t *store;
+    int idx;
 
-    /*------------------------------
-    UTF-8 을 UTF-16으로 변환한다.
+    if ((utf16 < HANGUL_SYLLABLE_BASE) ||
+        (utf16 >= HANGUL_SYLLABLE_BASE + HANGUL_SYLLABLE_COUNT))
+        return HANBlankImage;
 
-    UTF-8 1110xxxx 10xxxxxx 10xxxxxx
-    ------------------------------*/
-    utf16 = ((unsigned short)HAN1 & 0x000f) << 12 |
-            ((unsigned short)HAN2 & 0x003f) << 6  |
-            ((unsigned short)HAN3 & 0x003f);
-    utf16 -= 0xAC00;
+    idx = utf16 - HANGUL_SYLLABLE_BASE;
+    if ((store = HANStore[HANFONT_TYPE]) == NULL) {
+        if ((store = (hangul_store_t *)calloc(1, sizeof(hangul_store_t))) == NULL) {
+            err("hangul image store malloc error!\n");
+            return HANBlankImage;
+        }
+        HANStore[HANFONT_TYPE] = store;
+    }
+    image = store->image[idx];
+    if (store->valid[idx >> 3] & (1 << (idx & 7)))
+        return image;
+
+    utf16 = idx;
 
     /* 초성 / 중성 / 종성 분리 */
     l = (utf16 % 28);
@@ -122,118 +167,687 @@ static unsigned char *get_hangul_image( unsigned char HAN1,
     f2 = D_FM[(f * 2) + (l != 0)];
     f1 = D_MF[(m * 2) + (l != 0)];
 
-    memset(HANFontImage, 0, sizeof(HANFontImage));
-    if (f)  {   make_image(         1, HANFontImage, HANFONT1 + (f1*16 + f1 *4 + f) * 32);    first_flag = 0; }
-    if (m)  {   make_image(first_flag, HANFontImage, HANFONT2 + (        f2*22 + m) * 32);    first_flag = 0; }
-    if (l)  {   make_image(first_flag, HANFontImage, HANFONT3 + (f3*32 - f3 *4 + l) * 32);    first_flag = 0; }
+    if (f)  {   make_image(         1, image, HANFONT1 + (f1*16 + f1 *4 + f) * 32);    first_flag = 0; }
+    if (m)  {   make_image(first_flag, image, HANFONT2 + (        f2*22 + m) * 32);    first_flag = 0; }
+    if (l)  {   make_image(first_flag, image, HANFONT3 + (f3*32 - f3 *4 + l) * 32);    first_flag = 0; }
+
+    store->valid[idx >> 3] |= (1 << (idx & 7));
+    return image;
+}
+
+//-----------------------------------------------------------------------------
+// Pixel format backend
+//-----------------------------------------------------------------------------
+/*
+    0xRRGGBB 색상값을 framebuffer 메모리에 기록될 pixel 값으로 변환한다.
+    (little endian 기준, 하위 바이트부터 메모리에 기록됨)
+*/
+static unsigned int _pack_rgb565 (int color)
+{
+    return  ((UINT_TO_R(color) >> 3) << 11) |
+            ((UINT_TO_G(color) >> 2) <<  5) |
+            ((UINT_TO_B(color) >> 3)      );
+}
 
-    return HANFontImage;
+static unsigned int _pack_bgr565 (int color)
+{
+    return  ((UINT_TO_B(color) >> 3) << 11) |
+            ((UINT_TO_G(color) >> 2) <<  5) |
+            ((UINT_TO_R(color) >> 3)      );
+}
+
+static unsigned int _pack_xrgb8888 (int color)
+{
+    return  0xFF000000 | (UINT_TO_R(color) << 16) | (UINT_TO_G(color) << 8) | UINT_TO_B(color);
+}
+
+static unsigned int _pack_xbgr8888 (int color)
+{
+    return  0xFF000000 | (UINT_TO_B(color) << 16) | (UINT_TO_G(color) << 8) | UINT_TO_R(color);
+}
+
+//-----------------------------------------------------------------------------
+/*
+    framebuffer pixel 1 line을 R,G,B 순서의 24bits 데이터로 변환한다. (화면 dump용)
+*/
+#define TO_RGB_FUNC(name, type, r, g, b)                                        \
+static void name (unsigned char *rgb, const char *src, int w)                   \
+{                                                                               \
+    const type *p = (const type *)src;                                          \
+    unsigned int v;                                                             \
+                                                                                \
+    for (; w > 0; w--, p++) {                                                   \
+        v = *p;                                                                 \
+        *rgb++ = (r);   *rgb++ = (g);   *rgb++ = (b);                           \
+    }                                                                           \
+}
+
+#define C5(v)   ((((v) & 0x1F) << 3) | (((v) & 0x1F) >> 2))
+#define C6(v)   ((((v) & 0x3F) << 2) | (((v) & 0x3F) >> 4))
+
+TO_RGB_FUNC(_to_rgb_rgb565, unsigned short, C5(v >> 11), C6(v >> 5), C5(v))
+TO_RGB_FUNC(_to_rgb_bgr565, unsigned short, C5(v), C6(v >> 5), C5(v >> 11))
+TO_RGB_FUNC(_to_rgb_xrgb,   unsigned int, (v >> 16) & 0xFF, (v >> 8) & 0xFF, v & 0xFF)
+TO_RGB_FUNC(_to_rgb_xbgr,   unsigned int, v & 0xFF, (v >> 8) & 0xFF, (v >> 16) & 0xFF)
+
+static void _to_rgb_rgb888 (unsigned char *rgb, const char *src, int w)
+{
+    for (; w > 0; w--, src += 3) {
+        *rgb++ = src[2];    *rgb++ = src[1];    *rgb++ = src[0];
+    }
+}
+
+static void _to_rgb_bgr888 (unsigned char *rgb, const char *src, int w)
+{
+    memcpy(rgb, src, w * 3);
+}
+
+//-----------------------------------------------------------------------------
+static void _put16 (char *dst, unsigned int pixel)
+{
+    *(unsigned short *)dst = pixel;
+}
+
+static void _put24 (char *dst, unsigned int pixel)
+{
+    dst[0] = (pixel      ) & 0xFF;
+    dst[1] = (pixel >>  8) & 0xFF;
+    dst[2] = (pixel >> 16) & 0xFF;
+}
+
+static void _put32 (char *dst, unsigned int pixel)
+{
+    *(unsigned int *)dst = pixel;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    dst 위치부터 w 개의 pixel을 같은 값으로 채운다.
+    16/32bpp는 64bits 단위, 24bpp는 4 pixel 단위(12 bytes)로 기록한다.
+*/
+static void _fill_span16 (char *dst, int w, unsigned int pixel)
+{
+    unsigned short *p16 = (unsigned short *)dst;
+    unsigned long long *p64, pix64;
+
+    for (; ((unsigned long)p16 & 0x7) && w; w--)
+        *p16++ = pixel;
+    pix64 = pixel & 0xFFFF;
+    pix64 = (pix64 << 48) | (pix64 << 32) | (pix64 << 16) | pix64;
+    for (p64 = (unsigned long long *)p16; w >= 4; w -= 4)
+        *p64++ = pix64;
+    for (p16 = (unsigned short *)p64; w; w--)
+        *p16++ = pixel;
+}
+
+static void _fill_span24 (char *dst, int w, unsigned int pixel)
+{
+    unsigned char pat[12];
+    int i;
+
+    for (i = 0; i < 12; i += 3)
+        _put24((char *)&pat[i], pixel);
+    for (; w >= 4; w -= 4, dst += 12)
+        memcpy(dst, pat, 12);
+    if (w)
+        memcpy(dst, pat, w * 3);
+}
+
+static void _fill_span32 (char *dst, int w, unsigned int pixel)
+{
+    unsigned int *p32 = (unsigned int *)dst;
+    unsigned long long *p64, pix64;
+
+    if (((unsigned long)p32 & 0x7) && w) {
+        *p32++ = pixel;     w--;
+    }
+    pix64 = ((unsigned long long)pixel << 32) | pixel;
+    for (p64 = (unsigned long long *)p32; w >= 2; w -= 2)
+        *p64++ = pix64;
+    if (w)
+        *(unsigned int *)p64 = pixel;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    glyph 1 line(nbits, msb first)을 scale 배율로 확대하여 기록한다.
+    확대된 line의 skip 번째 pixel 부터 cnt 개의 pixel만 기록한다. (clipping)
+*/
+#define GLYPH_ROW_FUNC(name, type, put)                                         \
+static void name (char *dst, unsigned int bits, int nbits, int scale,          \
+                    int skip, int cnt, unsigned int fg, unsigned int bg)        \
+{                                                                               \
+    unsigned int mask = 1 << (nbits - 1 - (skip / scale)), c;                   \
+    int rep = scale - (skip % scale), n;                                        \
+                                                                                \
+    for (; cnt > 0; mask >>= 1, rep = scale) {                                  \
+        c = (bits & mask) ? fg : bg;                                            \
+        for (n = (rep < cnt) ? rep : cnt, cnt -= n; n; n--) {                   \
+            put(dst, c);    dst += sizeof(type);                                \
+        }                                                                       \
+    }                                                                           \
+}
+
+typedef struct { char b[3]; } __pixel24;
+
+GLYPH_ROW_FUNC(_glyph_row16, unsigned short, _put16)
+GLYPH_ROW_FUNC(_glyph_row24, __pixel24,      _put24)
+GLYPH_ROW_FUNC(_glyph_row32, unsigned int,   _put32)
+
+//-----------------------------------------------------------------------------
+// SIMD glyph kernel (x86 SSE2/AVX2, cpuid로 실행시 선택)
+//-----------------------------------------------------------------------------
+/*
+    확대된 glyph line의 o 번째 pixel이 참조하는 bit mask 표.
+    (16bits msb 정렬 기준, mask[o] = 0x8000 >> (o / scale))
+    scale이 바뀔 때만 다시 만든다.
+*/
+static unsigned int     GlyphMask32[FONT_HANGUL_WIDTH * FB_SCALE_MAX];
+static unsigned short   GlyphMask16[FONT_HANGUL_WIDTH * FB_SCALE_MAX];
+static int              GlyphMaskScale = 0;
+
+static void _glyph_mask_init (int scale)
+{
+    int o;
+
+    if (GlyphMaskScale == scale)
+        return;
+    for (o = 0; o < FONT_HANGUL_WIDTH * scale; o++) {
+        GlyphMask32[o] = 0x8000 >> (o / scale);
+        GlyphMask16[o] = 0x8000 >> (o / scale);
+    }
+    GlyphMaskScale = scale;
+}
+
+#if defined(FB_USE_SIMD)
+//-----------------------------------------------------------------------------
+__attribute__((target("sse2")))
+static void _glyph_row16_sse2 (char *dst, unsigned int bits, int nbits, int scale,
+                    int skip, int cnt, unsigned int fg, unsigned int bg)
+{
+    const unsigned short *mt;
+    __m128i vb, vf, vg, zero, sel;
+
+    _glyph_mask_init(scale);
+    mt   = GlyphMask16 + skip;
+    bits = bits << (16 - nbits);
+    vb   = _mm_set1_epi16(bits);
+    vf   = _mm_set1_epi16(fg);
+    vg   = _mm_set1_epi16(bg);
+    zero = _mm_setzero_si128();
+
+    for (; cnt >= 8; cnt -= 8, mt += 8, dst += 16) {
+        sel = _mm_cmpeq_epi16(_mm_and_si128(_mm_loadu_si128((const __m128i *)mt), vb), zero);
+        _mm_storeu_si128((__m128i *)dst,
+            _mm_or_si128(_mm_andnot_si128(sel, vf), _mm_and_si128(sel, vg)));
+    }
+    for (; cnt > 0; cnt--, mt++, dst += 2)
+        *(unsigned short *)dst = (*mt & bits) ? fg : bg;
+}
+
+//-----------------------------------------------------------------------------
+__attribute__((target("sse2")))
+static void _glyph_row32_sse2 (char *dst, unsigned int bits, int nbits, int scale,
+                    int skip, int cnt, unsigned int fg, unsigned int bg)
+{
+    const unsigned int *mt;
+    __m128i vb, vf, vg, zero, sel;
+
+    _glyph_mask_init(scale);
+    mt   = GlyphMask32 + skip;
+    bits = bits << (16 - nbits);
+    vb   = _mm_set1_epi32(bits);
+    vf   = _mm_set1_epi32(fg);
+    vg   = _mm_set1_epi32(bg);
+    zero = _mm_setzero_si128();
+
+    for (; cnt >= 4; cnt -= 4, mt += 4, dst += 16) {
+        sel = _mm_cmpeq_epi32(_mm_and_si128(_mm_loadu_si128((const __m128i *)mt), vb), zero);
+        _mm_storeu_si128((__m128i *)dst,
+            _mm_or_si128(_mm_andnot_si128(sel, vf), _mm_and_si128(sel, vg)));
+    }
+    for (; cnt > 0; cnt--, mt++, dst += 4)
+        *(unsigned int *)dst = (*mt & bits) ? fg : bg;
+}
+
+//-----------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static void _glyph_row16_avx2 (char *dst, unsigned int bits, int nbits, int scale,
+                    int skip, int cnt, unsigned int fg, unsigned int bg)
+{
+    const unsigned short *mt;
+    __m256i vb, vf, vg, zero, sel;
+
+    _glyph_mask_init(scale);
+    mt   = GlyphMask16 + skip;
+    bits = bits << (16 - nbits);
+    vb   = _mm256_set1_epi16(bits);
+    vf   = _mm256_set1_epi16(fg);
+    vg   = _mm256_set1_epi16(bg);
+    zero = _mm256_setzero_si256();
+
+    for (; cnt >= 16; cnt -= 16, mt += 16, dst += 32) {
+        sel = _mm256_cmpeq_epi16(_mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)mt), vb), zero);
+        _mm256_storeu_si256((__m256i *)dst, _mm256_blendv_epi8(vf, vg, sel));
+    }
+    for (; cnt > 0; cnt--, mt++, dst += 2)
+        *(unsigned short *)dst = (*mt & bits) ? fg : bg;
+}
+
+//-----------------------------------------------------------------------------
+__attribute__((target("avx2")))
+static void _glyph_row32_avx2 (char *dst, unsigned int bits, int nbits, int scale,
+                    int skip, int cnt, unsigned int fg, unsigned int bg)
+{
+    const unsigned int *mt;
+    __m256i vb, vf, vg, zero, sel;
+
+    _glyph_mask_init(scale);
+    mt   = GlyphMask32 + skip;
+    bits = bits << (16 - nbits);
+    vb   = _mm256_set1_epi32(bits);
+    vf   = _mm256_set1_epi32(fg);
+    vg   = _mm256_set1_epi32(bg);
+    zero = _mm256_setzero_si256();
+
+    for (; cnt >= 8; cnt -= 8, mt += 8, dst += 32) {
+        sel = _mm256_cmpeq_epi32(_mm256_and_si256(
+                _mm256_loadu_si256((const __m256i *)mt), vb), zero);
+        _mm256_storeu_si256((__m256i *)dst, _mm256_blendv_epi8(vf, vg, sel));
+    }
+    for (; cnt > 0; cnt--, mt++, dst += 4)
+        *(unsigned int *)dst = (*mt & bits) ? fg : bg;
+}
+#endif  // #if defined(FB_USE_SIMD)
+
+//-----------------------------------------------------------------------------
+/*
+    지원되는 pixel format 목록.
+    is_bgr 은 메모리에 기록되는 순서 기준 (blue 가 하위 bit에 위치하는 경우 1)
+    glyph_row 는 _fb_simd_init 에서 cpu 지원 여부에 따라 SIMD 함수로 교체된다.
+*/
+static fb_format_t FB_FORMATS[] = {
+    { "RGB565",   16, 2, true,  _pack_rgb565,   _put16, _fill_span16, _glyph_row16, _to_rgb_rgb565 },
+    { "BGR565",   16, 2, false, _pack_bgr565,   _put16, _fill_span16, _glyph_row16, _to_rgb_bgr565 },
+    { "RGB888",   24, 3, true,  _pack_xrgb8888, _put24, _fill_span24, _glyph_row24, _to_rgb_rgb888 },
+    { "BGR888",   24, 3, false, _pack_xbgr8888, _put24, _fill_span24, _glyph_row24, _to_rgb_bgr888 },
+    { "XRGB8888", 32, 4, true,  _pack_xrgb8888, _put32, _fill_span32, _glyph_row32, _to_rgb_xrgb   },
+    { "XBGR8888", 32, 4, false, _pack_xbgr8888, _put32, _fill_span32, _glyph_row32, _to_rgb_xbgr   },
+};
+
+static const fb_format_t *_fb_find_format (int bpp, bool is_bgr)
+{
+    unsigned int i;
+
+    _fb_simd_init();
+    for (i = 0; i < sizeof(FB_FORMATS) / sizeof(FB_FORMATS[0]); i++)
+        if ((FB_FORMATS[i].bpp == bpp) && (FB_FORMATS[i].is_bgr == is_bgr))
+            return &FB_FORMATS[i];
+    return NULL;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    cpu 지원 여부를 확인하여 16/32bpp glyph_row 함수를 SIMD 함수로 교체한다.
+    (환경변수 FB_NO_SIMD 가 설정되어있으면 scalar 함수 사용)
+*/
+static void _fb_simd_init (void)
+{
+    static bool is_init = false;
+#if defined(FB_USE_SIMD)
+    unsigned int i;
+    glyph_row_func row16 = NULL, row32 = NULL;
+
+    if (is_init)
+        return;
+    is_init = true;
+
+    if (getenv("FB_NO_SIMD") != NULL)
+        return;
+
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        row16 = _glyph_row16_avx2;  row32 = _glyph_row32_avx2;
+    } else if (__builtin_cpu_supports("sse2")) {
+        row16 = _glyph_row16_sse2;  row32 = _glyph_row32_sse2;
+    }
+    for (i = 0; row16 && (i < sizeof(FB_FORMATS) / sizeof(FB_FORMATS[0])); i++) {
+        if (FB_FORMATS[i].bpp == 16)    FB_FORMATS[i].glyph_row = row16;
+        if (FB_FORMATS[i].bpp == 32)    FB_FORMATS[i].glyph_row = row32;
+    }
+#else
+    is_init = true;
+#endif
+}
+
+//-----------------------------------------------------------------------------
+/* clip 영역 밖의 pixel은 무시한다. */
+static void _put_pixel (fb_info_t *fb, int x, int y, int color)
+{
+    const fb_rect_t *c = &fb->clip[fb->clip_cnt];
+
+    if ((x >= c->x) && (y >= c->y) && (x < c->x + c->w) && (y < c->y + c->h))
+        fb->fmt->put(fb->data + (y * fb->stride) + (x * fb->fmt->bypp),
+                        fb->fmt->pack(color));
 }
 
 //-----------------------------------------------------------------------------
 void put_pixel (fb_info_t *fb, int x, int y, int color)
 {
-    fb_color_u c;
-    int offset = (y * fb->stride) + (x * (fb->bpp >> 3));
+    _put_pixel(fb, x, y, color);
+    _fb_damage(fb, x, y, 1, 1);
+}
 
-    if ((x < fb->w) && (y < fb->h)) {
-        c.uint = color;
-        if (fb->is_bgr) {
-            *(fb->data + offset) = c.bits.b;  offset++;
-            *(fb->data + offset) = c.bits.g;  offset++;
-            *(fb->data + offset) = c.bits.r;  offset++;
-        } else {
-            *(fb->data + offset) = c.bits.r;  offset++;
-            *(fb->data + offset) = c.bits.g;  offset++;
-            *(fb->data + offset) = c.bits.b;  offset++;
+//-----------------------------------------------------------------------------
+/*
+    16 line의 glyph image(1 line = row_bytes)를 scale 배율로 확대하여 그린다.
+    화면 밖 영역은 line 단위로 잘라내고 색상 변환은 glyph당 한번만 한다.
+    확대된 line은 line buffer에 한번만 그린 후 반복되는 line에 복사한다.
+*/
+static void _fb_draw_glyph (fb_info_t *fb, int x, int y,
+                    const unsigned char *p_img, int row_bytes,
+                    int f_color, int b_color, int scale)
+{
+    int cx = x, cy = y, cw, ch, row, end, rep, i, nbits = row_bytes * 8;
+    unsigned int fg, bg, bits, line_bytes;
+    unsigned int line[FONT_HANGUL_WIDTH * FB_SCALE_MAX];
+    const unsigned char *src;
+    char *dst;
+
+    if (scale > FB_SCALE_MAX)
+        scale = FB_SCALE_MAX;
+
+    cw = nbits * scale;     ch = FONT_HEIGHT * scale;
+    if ((scale <= 0) || !_fb_clip_rect(fb, &cx, &cy, &cw, &ch))
+        return;
+
+    fg  = fb->fmt->pack(f_color);
+    bg  = fb->fmt->pack(b_color);
+    dst = fb->data + (cy * fb->stride) + (cx * fb->fmt->bypp);
+    line_bytes = cw * fb->fmt->bypp;
+
+    for (row = cy - y, end = cy - y + ch; row < end; row += rep) {
+        src  = p_img + (row / scale) * row_bytes;
+        bits = (row_bytes == 2) ? ((src[0] << 8) | src[1]) : src[0];
+        rep  = scale - (row % scale);
+        if (rep > (end - row))
+            rep = end - row;
+
+        if (rep == 1) {
+            fb->fmt->glyph_row(dst, bits, nbits, scale, cx - x, cw, fg, bg);
+            dst += fb->stride;
+            continue;
         }
-        if (fb->bpp == 32)
-            *(fb->data + offset) = 0xFF;
-    } else {
-        dbg("Out of range.(width = %d, x = %d, height = %d, y = %d)\n", 
-            fb->w, x, fb->h, y);
+        fb->fmt->glyph_row((char *)line, bits, nbits, scale, cx - x, cw, fg, bg);
+        for (i = 0; i < rep; i++, dst += fb->stride)
+            memcpy(dst, line, line_bytes);
     }
+    _fb_damage(fb, cx, cy, cw, ch);
 }
 
 //-----------------------------------------------------------------------------
-static void draw_hangul_bitmap (fb_info_t *fb,
-                    int x, int y, unsigned char *p_img,
-                    int f_color, int b_color, int scale)
+// Glyph tile cache
+//-----------------------------------------------------------------------------
+/*
+    확대 및 색상 변환이 끝난 glyph image(tile)를 LRU 방식으로 보관한다.
+    key = (한글 폰트, 문자코드, scale, 글자색, 배경색, pixel format)
+    같은 문자열을 반복하여 그리는 경우 tile을 line 단위로 복사만 한다.
+*/
+#define GLYPH_CACHE_HASH        256
+#define GLYPH_CACHE_DEFAULT     (2 * 1024 * 1024)
+
+typedef struct glyph_tile__t {
+    struct glyph_tile__t    *h_next;
+    struct glyph_tile__t    *prev, *next;
+    const fb_format_t       *fmt;
+    unsigned int            code, fg, bg;
+    int                     font, scale, w, h, size;
+    char                    pixel[];
+}   glyph_tile_t;
+
+static struct {
+    glyph_tile_t    *hash[GLYPH_CACHE_HASH];
+    /* head = 최근 사용, tail = 가장 오래전 사용 */
+    glyph_tile_t    *head, *tail;
+    unsigned long   used, max, hit, miss;
+}   GlyphCache = { .max = GLYPH_CACHE_DEFAULT };
+
+//-----------------------------------------------------------------------------
+static unsigned int _glyph_hash (unsigned int code, int font, int scale,
+                                unsigned int fg, unsigned int bg)
+{
+    unsigned int h = code * 2654435761u;
+
+    h ^= (fg * 31) ^ (bg * 131) ^ ((unsigned int)scale << 8) ^ ((unsigned int)font << 4);
+    return (h ^ (h >> 16)) & (GLYPH_CACHE_HASH - 1);
+}
+
+//-----------------------------------------------------------------------------
+static void _glyph_lru_unlink (glyph_tile_t *t)
+{
+    if (t->prev)    t->prev->next = t->next;    else GlyphCache.head = t->next;
+    if (t->next)    t->next->prev = t->prev;    else GlyphCache.tail = t->prev;
+    t->prev = t->next = NULL;
+}
+
+static void _glyph_lru_push (glyph_tile_t *t)
+{
+    t->prev = NULL;
+    t->next = GlyphCache.head;
+    if (GlyphCache.head)    GlyphCache.head->prev = t;
+    else                    GlyphCache.tail = t;
+    GlyphCache.head = t;
+}
+
+//-----------------------------------------------------------------------------
+/* 사용된지 가장 오래된 tile부터 제거하여 사용 메모리를 limit 이하로 줄인다. */
+static void _glyph_cache_evict (unsigned long limit)
 {
-    int pos, i, j, mask, x_off, y_off, scale_y, scale_x;
-
-    for (i = 0, y_off = 0, pos = 0; i < 16; i++) {
-        for (scale_y = 0; scale_y < scale; scale_y++) {
-            if (scale_y)
-                pos -= 2;
-            for (x_off = 0, j = 0; j < 2; j++) {
-                for (mask = 0x80; mask > 0; mask >>= 1) {
-                    for (scale_x = 0; scale_x < scale; scale_x++) {
-                        int c;
-                        c = (p_img[pos] & mask) ? f_color : b_color;
-
-                        put_pixel(fb, x + x_off, y + y_off, c);
-                        x_off++;
-                    }
-                }
-                pos++;
+    glyph_tile_t *t, **pp;
+
+    while (GlyphCache.tail && (GlyphCache.used > limit)) {
+        t = GlyphCache.tail;
+        _glyph_lru_unlink(t);
+
+        pp = &GlyphCache.hash[_glyph_hash(t->code, t->font, t->scale, t->fg, t->bg)];
+        for (; *pp; pp = &(*pp)->h_next) {
+            if (*pp == t) {
+                *pp = t->h_next;
+                break;
+            }
+        }
+        GlyphCache.used -= t->size;
+        free(t);
+    }
+}
+
+//-----------------------------------------------------------------------------
+static glyph_tile_t *_glyph_cache_find (const fb_format_t *fmt, unsigned int code,
+                        int font, int scale, unsigned int fg, unsigned int bg)
+{
+    glyph_tile_t *t = GlyphCache.hash[_glyph_hash(code, font, scale, fg, bg)];
+
+    for (; t; t = t->h_next) {
+        if ((t->code == code) && (t->scale == scale) && (t->fg == fg) &&
+            (t->bg == bg) && (t->font == font) && (t->fmt == fmt)) {
+            if (t != GlyphCache.head) {
+                _glyph_lru_unlink(t);
+                _glyph_lru_push(t);
             }
-            y_off++;
+            GlyphCache.hit++;
+            return t;
         }
     }
+    GlyphCache.miss++;
+    return NULL;
 }
 
 //-----------------------------------------------------------------------------
-static void draw_ascii_bitmap (fb_info_t *fb,
-                    int x, int y, unsigned char *p_img,
+/*
+    glyph image를 확대/색상 변환하여 새로운 tile을 만들어 cache에 등록한다.
+    tile 크기가 cache 최대 크기보다 크거나 메모리가 없으면 NULL.
+*/
+static glyph_tile_t *_glyph_cache_add (const fb_format_t *fmt, unsigned int code,
+                        int font, int scale, unsigned int fg, unsigned int bg,
+                        const unsigned char *p_img, int row_bytes)
+{
+    int w = row_bytes * 8 * scale, h = FONT_HEIGHT * scale, row, stride, i;
+    unsigned int bits, size;
+    glyph_tile_t *t;
+    char *dst;
+
+    stride = w * fmt->bypp;
+    size   = sizeof(glyph_tile_t) + stride * h;
+    if (size > GlyphCache.max)
+        return NULL;
+
+    _glyph_cache_evict(GlyphCache.max - size);
+    if ((t = (glyph_tile_t *)malloc(size)) == NULL)
+        return NULL;
+
+    t->fmt  = fmt;      t->code  = code;    t->fg = fg;     t->bg = bg;
+    t->font = font;     t->scale = scale;   t->w  = w;      t->h  = h;
+    t->size = size;
+
+    for (row = 0, dst = t->pixel; row < FONT_HEIGHT; row++) {
+        bits = (row_bytes == 2) ?
+                ((p_img[row * 2] << 8) | p_img[row * 2 + 1]) : p_img[row];
+        fmt->glyph_row(dst, bits, row_bytes * 8, scale, 0, w, fg, bg);
+        for (i = 1, dst += stride; i < scale; i++, dst += stride)
+            memcpy(dst, dst - stride, stride);
+    }
+
+    i = _glyph_hash(code, font, scale, fg, bg);
+    t->h_next = GlyphCache.hash[i];
+    GlyphCache.hash[i] = t;
+    _glyph_lru_push(t);
+    GlyphCache.used += size;
+    return t;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    문자 1개를 그린다. (code : ASCII 또는 UTF-16 한글 코드)
+    cache에 tile이 있으면 line 단위 복사, 없으면 tile을 만든 후 복사한다.
+*/
+static void _fb_draw_char (fb_info_t *fb, int x, int y, unsigned int code,
                     int f_color, int b_color, int scale)
 {
-    int pos, mask, x_off, y_off, scale_y, scale_x;
+    int cx = x, cy = y, cw, ch, row_bytes, font, len, row;
+    const unsigned char *p_img = NULL;
+    unsigned int fg, bg;
+    glyph_tile_t *t;
+    char *src, *dst;
 
-    for (pos = 0, y_off = 0; pos < 16; pos++) {
-        for (scale_y = 0; scale_y < scale; scale_y++) {
-            for (x_off = 0, mask = 0x80; mask > 0; mask >>= 1) {
-                for (scale_x = 0; scale_x < scale; scale_x++) {
-                    int c;
-                    c = (p_img[pos] & mask) ? f_color : b_color;
+    row_bytes = (code >= 0x80) ? (FONT_HANGUL_WIDTH / 8) : (FONT_ASCII_WIDTH / 8);
+    font      = (code >= 0x80) ? (int)HANFONT_TYPE : -1;
 
-                    put_pixel(fb, x + x_off, y + y_off, c);
-                    x_off++;
-                }
-            }
-            y_off++;
+    if (scale > FB_SCALE_MAX)
+        scale = FB_SCALE_MAX;
+
+    cw = row_bytes * 8 * scale;     ch = FONT_HEIGHT * scale;
+    if ((scale <= 0) || !_fb_clip_rect(fb, &cx, &cy, &cw, &ch))
+        return;
+
+    fg = fb->fmt->pack(f_color);
+    bg = fb->fmt->pack(b_color);
+
+    if ((t = _glyph_cache_find(fb->fmt, code, font, scale, fg, bg)) == NULL) {
+        p_img = (code >= 0x80) ? get_hangul_image(code) :
+                                    (const unsigned char *)FONT_ASCII[code];
+        t = _glyph_cache_add(fb->fmt, code, font, scale, fg, bg, p_img, row_bytes);
+    }
+    if (t == NULL) {
+        _fb_draw_glyph(fb, x, y, p_img, row_bytes, f_color, b_color, scale);
+        return;
+    }
+
+    len = cw * fb->fmt->bypp;
+    src = t->pixel + ((cy - y) * t->w + (cx - x)) * fb->fmt->bypp;
+    dst = fb->data + (cy * fb->stride) + (cx * fb->fmt->bypp);
+    for (row = 0; row < ch; row++, src += t->w * fb->fmt->bypp, dst += fb->stride)
+        memcpy(dst, src, len);
+
+    _fb_damage(fb, cx, cy, cw, ch);
+}
+
+//-----------------------------------------------------------------------------
+void fb_glyph_cache_size (unsigned long max_bytes)
+{
+    GlyphCache.max = max_bytes;
+    _glyph_cache_evict(max_bytes);
+}
+
+//-----------------------------------------------------------------------------
+void fb_glyph_cache_stat (unsigned long *hit, unsigned long *miss, unsigned long *used)
+{
+    if (hit)    *hit  = GlyphCache.hit;
+    if (miss)   *miss = GlyphCache.miss;
+    if (used)   *used = GlyphCache.used;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    UTF-8 문자 1개를 읽어 code point를 반환하고 *p_str을 다음 문자로 옮긴다.
+    lead byte로 길이(1~4바이트)를 정하며, 잘못되었거나 중간에 잘린 sequence는
+    1바이트만 건너뛰고 FB_UTF8_INVALID를 반환한다. (문자열 끝을 넘어 읽지 않음)
+*/
+unsigned int fb_utf8_decode (const char **p_str)
+{
+    const unsigned char *s = (const unsigned char *)*p_str;
+    unsigned int code;
+    int len, i;
+
+    if      (s[0] < 0x80)           {   *p_str += 1;    return s[0];        }
+    else if ((s[0] & 0xE0) == 0xC0) {   len = 2;    code = s[0] & 0x1F;     }
+    else if ((s[0] & 0xF0) == 0xE0) {   len = 3;    code = s[0] & 0x0F;     }
+    else if ((s[0] & 0xF8) == 0xF0) {   len = 4;    code = s[0] & 0x07;     }
+    else                            {   *p_str += 1;    return FB_UTF8_INVALID; }
+
+    for (i = 1; i < len; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            *p_str += 1;
+            return FB_UTF8_INVALID;
         }
+        code = (code << 6) | (s[i] & 0x3F);
     }
+    *p_str += len;
+    return code;
 }
 
 //-----------------------------------------------------------------------------
 static void _draw_text (fb_info_t *fb, int x, int y, char *p_str,
                         int f_color, int b_color, int scale)
 {
-    unsigned char *p_img;
-    unsigned char c1, c2, c3;
+    unsigned int code;
+    const char *p = p_str;
+    const fb_rect_t *c = &fb->clip[fb->clip_cnt];
 
-    while(*p_str) { 
-        c1 = *(unsigned char *)p_str++;
+    /* 문자열 전체가 clip 영역의 위/아래에 있으면 그리지 않는다. */
+    if ((y >= c->y + c->h) || (y + FONT_HEIGHT * scale <= c->y))
+        return;
+
+    /* clip 영역의 오른쪽을 넘어가는 문자는 그리지 않는다. */
+    while(*p && (x < c->x + c->w)) {
+        /* 모든 문자는 UTF-8형태로 저장되며 code point로 변환하여 그린다. */
+        code = fb_utf8_decode(&p);
 
         //---------- 한글 ---------
-        /* 모든 문자는 기본적으로 UTF-8형태로 저장되며 한글은 3바이트를 가진다. */
-        /* 한글은 3바이트를 일어 UTF8 to UTF16으로 변환후 초/중/종성을 분리하여 조합형으로 표시한다. */
-        if (c1 >= 0x80){
-            c2 = *(unsigned char *)p_str++;
-            c3 = *(unsigned char *)p_str++;
-
-            p_img = get_hangul_image(c1, c2, c3);
-            draw_hangul_bitmap(fb, x, y, p_img, f_color, b_color, scale);
+        /*
+            한글은 초/중/종성을 분리하여 조합형으로 표시한다.
+            한글 음절 이외의 문자는 빈 image (한글 폭)로 표시된다.
+        */
+        if (code >= 0x80){
+            _fb_draw_char(fb, x, y, code, f_color, b_color, scale);
             x = x + FONT_HANGUL_WIDTH * scale;
         }
         //---------- ASCII ---------
         else {
-            p_img = (unsigned char *)FONT_ASCII[c1];
-            draw_ascii_bitmap(fb, x, y, p_img, f_color, b_color, scale);
+            _fb_draw_char(fb, x, y, code, f_color, b_color, scale);
             x = x + FONT_ASCII_WIDTH * scale;
         }
-    }  
+    }
 }
 
 //-----------------------------------------------------------------------------
@@ -253,43 +867,315 @@ void draw_text (fb_info_t *fb, int x, int y,
 }
 
 //-----------------------------------------------------------------------------
-void draw_line (fb_info_t *fb, int x, int y, int w, int color)
+/*
+    사각 영역을 c 영역에 맞게 잘라낸다.
+    그릴 영역이 남아있지 않으면 0을 반환한다.
+*/
+static int _fb_clip_to (const fb_rect_t *c, int *x, int *y, int *w, int *h)
+{
+    if (*x < c->x)                  {   *w -= c->x - *x;    *x = c->x;  }
+    if (*y < c->y)                  {   *h -= c->y - *y;    *y = c->y;  }
+    if (*x + *w > c->x + c->w)          *w = c->x + c->w - *x;
+    if (*y + *h > c->y + c->h)          *h = c->y + c->h - *y;
+
+    return ((*w > 0) && (*h > 0));
+}
+
+//-----------------------------------------------------------------------------
+/* 현재 clip 영역(clip stack의 top, 기본값은 전체 화면)에 맞게 잘라낸다. */
+static int _fb_clip_rect (fb_info_t *fb, int *x, int *y, int *w, int *h)
+{
+    return _fb_clip_to(&fb->clip[fb->clip_cnt], x, y, w, h);
+}
+
+//-----------------------------------------------------------------------------
+/*
+    clip 영역을 추가한다. 새로운 영역은 현재 clip 영역과의 교집합이 되며
+    fb_pop_clip 전까지 모든 그리기 함수는 이 영역 안에서만 동작한다.
+*/
+bool fb_push_clip (fb_info_t *fb, int x, int y, int w, int h)
+{
+    fb_rect_t *c;
+
+    if (fb->clip_cnt >= FB_CLIP_DEPTH) {
+        err("clip stack overflow!\n");
+        return false;
+    }
+    if (!_fb_clip_rect(fb, &x, &y, &w, &h))
+        w = h = 0;
+
+    c = &fb->clip[++fb->clip_cnt];
+    c->x = x;   c->y = y;   c->w = w;   c->h = h;
+    return true;
+}
+
+//-----------------------------------------------------------------------------
+void fb_pop_clip (fb_info_t *fb)
+{
+    if (fb->clip_cnt)
+        fb->clip_cnt--;
+}
+
+//-----------------------------------------------------------------------------
+static void _fb_fill_rect (fb_info_t *fb, int x, int y, int w, int h, int color)
 {
-    int dx;
+    unsigned int pixel;
+    char *dst;
+
+    if (!_fb_clip_rect(fb, &x, &y, &w, &h))
+        return;
 
-    for (dx = 0; dx < w; dx++)
-        put_pixel(fb, x + dx, y, color);
+    pixel = fb->fmt->pack(color);
+    dst   = fb->data + (y * fb->stride) + (x * fb->fmt->bypp);
+
+    _fb_damage(fb, x, y, w, h);
+    for (; h > 0; h--, dst += fb->stride)
+        fb->fmt->fill_span(dst, w, pixel);
+}
+
+//-----------------------------------------------------------------------------
+void draw_line (fb_info_t *fb, int x, int y, int w, int color)
+{
+    _fb_fill_rect(fb, x, y, w, 1, color);
 }
 
 //-----------------------------------------------------------------------------
 void draw_rect (fb_info_t *fb, int x, int y, int w, int h, int lw, int color)
 {
-	int dy, i;
+    int side_h;
 
-	for (dy = 0; dy < h; dy++) {
-        if (dy < lw || (dy > (h - lw -1)))
-            draw_line (fb, x, y + dy, w, color);
-        else {
-            for (i = 0; i < lw; i++) {
-                put_pixel (fb, x + 0    +i, y + dy, color);
-                put_pixel (fb, x + w -1 -i, y + dy, color);
-            }
-        }
-	}
+    if (lw <= 0)
+        return;
+
+    /* 위/아래 외곽선 */
+    if (h <= (lw * 2)) {
+        _fb_fill_rect(fb, x, y, w, h, color);
+        return;
+    }
+    _fb_fill_rect(fb, x, y,          w, lw, color);
+    _fb_fill_rect(fb, x, y + h - lw, w, lw, color);
+
+    /* 좌/우 외곽선 */
+    side_h = h - (lw * 2);
+    _fb_fill_rect(fb, x,          y + lw, lw, side_h, color);
+    _fb_fill_rect(fb, x + w - lw, y + lw, lw, side_h, color);
 }
 
 //-----------------------------------------------------------------------------
 void draw_fill_rect (fb_info_t *fb, int x, int y, int w, int h, int color)
 {
-	int dy;
+    _fb_fill_rect(fb, x, y, w, h, color);
+}
+
+//-----------------------------------------------------------------------------
+/*
+    (sx, sy) 위치의 w x h 영역을 (dx, dy)로 옮긴다. (scroll 용, 영역이 겹쳐도 됨)
+    옮겨질 영역은 현재 clip 영역으로, 원본 영역은 화면 영역으로 자른다.
+    pixel은 line 단위로 복사되며 다시 그리는 동작은 없다.
+*/
+void fb_move_rect (fb_info_t *fb, int sx, int sy, int w, int h, int dx, int dy)
+{
+    int ox = dx, oy = dy, len, row;
+    char *src, *dst;
+
+    if (!_fb_clip_rect(fb, &dx, &dy, &w, &h))
+        return;
+    sx += dx - ox;  sy += dy - oy;
+
+    ox = sx;    oy = sy;
+    if (!_fb_clip_to(&fb->clip[0], &sx, &sy, &w, &h))
+        return;
+    dx += sx - ox;  dy += sy - oy;
+
+    len = w * fb->fmt->bypp;
+    src = fb->data + (sy * fb->stride) + (sx * fb->fmt->bypp);
+    dst = fb->data + (dy * fb->stride) + (dx * fb->fmt->bypp);
+
+    /* 위로 옮기는 경우 위쪽 line부터, 아래로 옮기는 경우 아래쪽 line부터 복사 */
+    if (dy <= sy) {
+        for (row = 0; row < h; row++, src += fb->stride, dst += fb->stride)
+            memmove(dst, src, len);
+    } else {
+        src += (h - 1) * fb->stride;    dst += (h - 1) * fb->stride;
+        for (row = 0; row < h; row++, src -= fb->stride, dst -= fb->stride)
+            memmove(dst, src, len);
+    }
+    _fb_damage(fb, dx, dy, w, h);
+}
+
+//-----------------------------------------------------------------------------
+/*
+    shadow buffer 사용시 변경된 영역을 damage list에 추가한다.
+    기존 영역과 겹치거나 맞닿아 있으면 하나의 영역으로 합치며,
+    list가 가득 찬 경우 모든 영역을 감싸는 하나의 영역으로 합친다.
+*/
+static void _fb_damage (fb_info_t *fb, int x, int y, int w, int h)
+{
+    fb_rect_t *d;
+    int i, x2, y2;
+
+    if (!fb->shadow || !_fb_clip_to(&fb->clip[0], &x, &y, &w, &h))
+        return;
+
+    x2 = x + w;     y2 = y + h;
+    for (i = 0; i < fb->damage_cnt; ) {
+        d = &fb->damage[i];
+        if ((x <= d->x + d->w) && (d->x <= x2) && (y <= d->y + d->h) && (d->y <= y2)) {
+            if (d->x < x)               x  = d->x;
+            if (d->y < y)               y  = d->y;
+            if (d->x + d->w > x2)       x2 = d->x + d->w;
+            if (d->y + d->h > y2)       y2 = d->y + d->h;
+            /* 합쳐진 영역을 제거하고 처음부터 다시 검사 */
+            fb->damage[i] = fb->damage[--fb->damage_cnt];
+            i = 0;
+            continue;
+        }
+        i++;
+    }
+    if (fb->damage_cnt == FB_DAMAGE_MAX) {
+        for (i = 0; i < fb->damage_cnt; i++) {
+            d = &fb->damage[i];
+            if (d->x < x)               x  = d->x;
+            if (d->y < y)               y  = d->y;
+            if (d->x + d->w > x2)       x2 = d->x + d->w;
+            if (d->y + d->h > y2)       y2 = d->y + d->h;
+        }
+        fb->damage_cnt = 0;
+    }
+    d = &fb->damage[fb->damage_cnt++];
+    d->x = x;   d->y = y;   d->w = x2 - x;  d->h = y2 - y;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    shadow buffer의 변경 영역을 화면 메모리(vram)로 복사한다.
+    line 단위 복사 비용을 고려하여 변경 영역이 화면의 대부분(3/4 이상)인 경우
+    전체 화면을 한번에 복사한다.
+*/
+#define FB_FLUSH_LINE_COST  64
+
+static unsigned long _fb_damage_cost (fb_info_t *fb, fb_rect_t *rects, int cnt)
+{
+    unsigned long cost = 0;
+    int i;
+
+    for (i = 0; i < cnt; i++)
+        cost += (unsigned long)rects[i].h *
+                (rects[i].w * fb->fmt->bypp + FB_FLUSH_LINE_COST);
+    return cost;
+}
+
+static void _fb_copy_rects (fb_info_t *fb, fb_rect_t *rects, int cnt)
+{
+    int i, y, offset, bypp = fb->fmt->bypp;
+
+    for (i = 0; i < cnt; i++) {
+        offset = (rects[i].y * fb->stride) + (rects[i].x * bypp);
+        for (y = 0; y < rects[i].h; y++, offset += fb->stride)
+            memcpy(fb->vram + offset, fb->shadow + offset, rects[i].w * bypp);
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*
+    back page를 화면에 표시(pan)하고 vsync를 기다린다.
+    pan을 지원하지 않는 driver인 경우 single page로 전환한다.
+*/
+static void _fb_flip (fb_info_t *fb)
+{
+    struct fb_var_screeninfo fvsi;
+    int back = fb->page_front ^ 1, arg = 0;
+
+    if (ioctl(fb->fd, FBIOGET_VSCREENINFO, &fvsi) == 0) {
+        fvsi.xoffset = 0;
+        fvsi.yoffset = back * fb->h;
+        if (ioctl(fb->fd, FBIOPAN_DISPLAY, &fvsi) == 0) {
+            /* vsync 미지원 driver는 무시 */
+            ioctl(fb->fd, FBIO_WAITFORVSYNC, &arg);
+            fb->page_front = back;
+            fb->vram       = fb->page[back ^ 1];
+            return;
+        }
+    }
+    err("FBIOPAN_DISPLAY fail! page flip disabled.\n");
+    memcpy(fb->page[fb->page_front], fb->page[back], fb->stride * fb->h);
+    fb->page_cnt = 1;
+    fb->vram     = fb->page[fb->page_front];
+}
+
+//-----------------------------------------------------------------------------
+void fb_flush (fb_info_t *fb)
+{
+    unsigned long cost, full;
+
+    if (!fb || !fb->shadow || (!fb->damage_cnt && !fb->flip_full))
+        return;
 
-	for (dy = 0; dy < h; dy++)
-        draw_line(fb, x, y + dy, w, color);
+    /*
+        page flip 사용시 back page는 한 frame 이전의 화면이므로
+        이전 frame의 변경 영역도 같이 복사한다.
+    */
+    full = (unsigned long)fb->h * (fb->stride + FB_FLUSH_LINE_COST);
+    cost = _fb_damage_cost(fb, fb->damage, fb->damage_cnt) +
+            _fb_damage_cost(fb, fb->prev_damage, fb->prev_damage_cnt);
+
+    if (fb->flip_full || ((cost * 4) >= (full * 3))) {
+        memcpy(fb->vram, fb->shadow, fb->stride * fb->h);
+        if (fb->flip_full)
+            fb->flip_full--;
+    } else {
+        _fb_copy_rects(fb, fb->damage, fb->damage_cnt);
+        _fb_copy_rects(fb, fb->prev_damage, fb->prev_damage_cnt);
+    }
+
+    if (fb->page_cnt == 2) {
+        memcpy(fb->prev_damage, fb->damage, sizeof(fb_rect_t) * fb->damage_cnt);
+        fb->prev_damage_cnt = fb->damage_cnt;
+        _fb_flip(fb);
+    }
+    fb->damage_cnt = 0;
+}
+
+//-----------------------------------------------------------------------------
+/*
+    system ram에 back buffer(shadow)를 할당하여 모든 그리기 동작을 shadow에서 처리한다.
+    화면 반영은 fb_flush 호출시 변경된 영역만 vram으로 복사된다.
+    framebuffer가 2 page를 지원하면 back page에 복사한 후 page flip 한다.
+*/
+bool fb_shadow_enable (fb_info_t *fb, bool enable)
+{
+    if (enable) {
+        if (fb->shadow)
+            return true;
+        if ((fb->shadow = (char *)malloc(fb->stride * fb->h)) == NULL) {
+            err("shadow buffer malloc error!\n");
+            return false;
+        }
+        memcpy(fb->shadow, fb->vram, fb->stride * fb->h);
+        fb->data       = fb->shadow;
+        fb->damage_cnt = 0;
+        fb->prev_damage_cnt = 0;
+        if (fb->page_cnt == 2) {
+            /* 두 page 모두 한번은 전체 복사 */
+            fb->vram      = fb->page[fb->page_front ^ 1];
+            fb->flip_full = 2;
+        }
+    } else if (fb->shadow) {
+        fb_flush(fb);
+        free(fb->shadow);
+        fb->shadow = NULL;
+        fb->vram   = fb->page_cnt == 2 ? fb->page[fb->page_front] : fb->vram;
+        fb->data   = fb->vram;
+        fb->flip_full = 0;
+    }
+    return true;
 }
 
 //-----------------------------------------------------------------------------
 void set_font(enum eFONTS_HANGUL s_font)
 {
+    HANFONT_TYPE = ((s_font > eFONT_HAN_DEFAULT) && (s_font < eFONT_END)) ?
+                    s_font : eFONT_HAN_DEFAULT;
     switch(s_font)
     {
         case    eFONT_HANBOOT:
@@ -324,19 +1210,154 @@ void set_font(enum eFONTS_HANGUL s_font)
 //-----------------------------------------------------------------------------
 void fb_clear (fb_info_t *fb)
 {
-    memset(fb->data, 0x00, (fb->w * fb->h * fb->bpp) / 8);
+    /* line 끝의 padding 영역까지 포함하여 지운다. */
+    memset(fb->data, 0x00, fb->stride * fb->h);
+    _fb_damage(fb, 0, 0, fb->w, fb->h);
+}
+
+//-----------------------------------------------------------------------------
+/*
+    pixel 배열 순서를 변경한다. (UI config의 LCD RGB배열 설정)
+*/
+void fb_set_bgr (fb_info_t *fb, bool is_bgr)
+{
+    const fb_format_t *fmt = _fb_find_format(fb->bpp, is_bgr);
+
+    if (fmt) {
+        fb->is_bgr = is_bgr;
+        fb->fmt    = fmt;
+    }
+}
+
+//-----------------------------------------------------------------------------
+/*
+    현재 그려진 화면(fb->data)을 파일로 저장한다.
+    확장자가 .ppm 이면 P6(PPM) 형식, 그 외는 framebuffer 메모리 그대로(raw) 저장.
+*/
+bool fb_dump (fb_info_t *fb, const char *filename)
+{
+    FILE *fp;
+    unsigned char *rgb = NULL;
+    const char *ext = strrchr(filename, '.');
+    bool is_ppm = (ext != NULL) && !strcmp(ext, ".ppm");
+    int y, ok = 1;
+
+    if ((fp = fopen(filename, "wb")) == NULL) {
+        err("%s file open fail!\n", filename);
+        return false;
+    }
+
+    if (is_ppm) {
+        if ((rgb = (unsigned char *)malloc(fb->w * 3)) == NULL) {
+            fclose(fp);
+            return false;
+        }
+        fprintf(fp, "P6\n%d %d\n255\n", fb->w, fb->h);
+    }
+    for (y = 0; (y < fb->h) && ok; y++) {
+        if (is_ppm) {
+            fb->fmt->to_rgb(rgb, fb->data + y * fb->stride, fb->w);
+            ok = fwrite(rgb, fb->w * 3, 1, fp);
+        } else {
+            ok = fwrite(fb->data + y * fb->stride, fb->w * fb->fmt->bypp, 1, fp);
+        }
+    }
+    if (rgb)
+        free(rgb);
+    fclose(fp);
+    return ok ? true : false;
 }
 
 //-----------------------------------------------------------------------------
 void fb_close (fb_info_t *fb)
 {
     if (fb) {
-        if (fb->fd)
+        if (fb->shadow)
+            fb_shadow_enable(fb, false);
+        /* console(fbcon)이 사용하는 첫번째 page로 복귀 */
+        if ((fb->page_cnt == 2) && fb->page_front) {
+            fb_shadow_enable(fb, true);
+            fb->flip_full = 1;
+            fb_flush(fb);
+            fb_shadow_enable(fb, false);
+        }
+        if (fb->base && (fb->base != (char *)-1))
+            munmap (fb->base, fb->size);
+        if (fb->fd > 0)
             close (fb->fd);
         free (fb);
     }
 }
 
+//-----------------------------------------------------------------------------
+/*
+    framebuffer device 없이 동작하는 surface를 만든다.
+    "mem:{w}x{h}x{bpp}"         : system ram에 할당 (headless 실행, benchmark)
+    "file:{path}:{w}x{h}x{bpp}" : 파일에 mmap (다른 프로세스에서 화면 확인 가능)
+    pixel format은 bpp에 따라 RGB565, RGB888, XRGB8888 로 시작한다.
+*/
+static bool _fb_init_surface (fb_info_t *fb, const char *spec)
+{
+    char path[256];
+    const char *geo;
+
+    fb->fd = -1;
+    if (!strncmp(spec, "mem:", strlen("mem:"))) {
+        fb->type = eFB_TYPE_MEM;
+        geo = spec + strlen("mem:");
+    } else {
+        fb->type = eFB_TYPE_FILE;
+        spec += strlen("file:");
+        if (((geo = strrchr(spec, ':')) == NULL) || ((geo - spec) >= (int)sizeof(path))) {
+            err("file surface spec error! (%s)\n", spec);
+            return false;
+        }
+        memset (path, 0x00, sizeof(path));
+        strncpy(path, spec, geo - spec);
+        geo++;
+    }
+
+    if ((sscanf(geo, "%dx%dx%d", &fb->w, &fb->h, &fb->bpp) != 3) ||
+        (fb->w <= 0) || (fb->h <= 0)) {
+        err("surface geometry error! (%s)\n", geo);
+        return false;
+    }
+    fb->is_bgr = true;
+    if ((fb->fmt = _fb_find_format(fb->bpp, fb->is_bgr)) == NULL) {
+        err("unsupported bits per pixel(%d)\n", fb->bpp);
+        return false;
+    }
+    fb->stride = (fb->w * fb->fmt->bypp + 3) & ~3;
+    fb->size   = (unsigned long)fb->stride * fb->h;
+
+    if (fb->type == eFB_TYPE_FILE) {
+        if ((fb->fd = open(path, O_RDWR | O_CREAT, 0644)) < 0) {
+            err("%s file open fail!\n", path);
+            return false;
+        }
+        if (ftruncate(fb->fd, fb->size) < 0) {
+            err("%s file resize fail!\n", path);
+            return false;
+        }
+        fb->base = (char *)mmap(NULL, fb->size, PROT_READ | PROT_WRITE,
+                                MAP_SHARED, fb->fd, 0);
+    } else {
+        fb->base = (char *)mmap(NULL, fb->size, PROT_READ | PROT_WRITE,
+                                MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    }
+    if (fb->base == (char *)-1) {
+        err("mmap");
+        return false;
+    }
+    fb->clip[0].w = fb->w;
+    fb->clip[0].h = fb->h;
+    fb->page_cnt = 1;
+    fb->page[0]  = fb->base;
+    fb->vram = fb->base;
+    fb->data = fb->vram;
+    return true;
+}
+
 //-----------------------------------------------------------------------------
 fb_info_t *fb_init (const char *DEVICE_NAME)
 {
@@ -351,9 +1372,19 @@ fb_info_t *fb_init (const char *DEVICE_NAME)
     }
 	memset(fb, 0, sizeof(fb_info_t));
 
+    /* framebuffer device 대신 memory/file surface 사용 */
+    if (!strncmp(DEVICE_NAME, "mem:", strlen("mem:")) ||
+        !strncmp(DEVICE_NAME, "file:", strlen("file:"))) {
+        if (!_fb_init_surface(fb, DEVICE_NAME))
+            goto out;
+        fb_clear(fb);
+        return  fb;
+    }
+
+    fb->type = eFB_TYPE_DEV;
 	if ((fb->fd = open(DEVICE_NAME, O_RDWR)) < 0) {
 		err("open");
-        return NULL;
+        goto out;
 	}
 	if (ioctl(fb->fd, FBIOGET_VSCREENINFO, &fvsi) < 0) {
 		err("ioctl(FBIOGET_VSCREENINFO)");
@@ -364,16 +1395,51 @@ fb_info_t *fb_init (const char *DEVICE_NAME)
         goto out;
 	}
 
+    /*
+        page flip을 위하여 2배 높이의 virtual 화면을 요청한다.
+        driver가 지원하지 않는 경우 single page로 동작한다.
+    */
+    if (fvsi.yres_virtual < (fvsi.yres * 2)) {
+        struct fb_var_screeninfo req = fvsi;
+
+        req.yres_virtual = fvsi.yres * 2;
+        req.yoffset      = 0;
+        if (ioctl(fb->fd, FBIOPUT_VSCREENINFO, &req) == 0) {
+            ioctl(fb->fd, FBIOGET_VSCREENINFO, &fvsi);
+            ioctl(fb->fd, FBIOGET_FSCREENINFO, &ffsi);
+        }
+    }
+
 	fb->w       = fvsi.xres;
 	fb->h       = fvsi.yres;
 	fb->bpp     = fvsi.bits_per_pixel;
 	fb->stride  = ffsi.line_length;
+    fb->clip[0].w = fb->w;
+    fb->clip[0].h = fb->h;
 
-	if (fvsi.red.length != 8 || fvsi.green.length != 8 || fvsi.blue.length != 8) {
-		err("mmap");
+    fb->page_cnt = ((fvsi.yres_virtual >= (fvsi.yres * 2)) && ffsi.ypanstep &&
+                    (ffsi.smem_len >= (ffsi.line_length * fvsi.yres * 2))) ? 2 : 1;
+    fb->page_front = (fb->page_cnt == 2) ? ((fvsi.yoffset / fvsi.yres) & 1) : 0;
+
+    /* framebuffer의 bit 배열을 확인하여 pixel format backend를 선택한다. */
+    if (fb->bpp == 16) {
+        if (fvsi.red.length != 5 || fvsi.green.length != 6 || fvsi.blue.length != 5) {
+            err("unsupported 16bpp format(r%d g%d b%d)\n",
+                fvsi.red.length, fvsi.green.length, fvsi.blue.length);
+            goto out;
+        }
+    } else if (fvsi.red.length != 8 || fvsi.green.length != 8 || fvsi.blue.length != 8) {
+        err("unsupported %dbpp format(r%d g%d b%d)\n", fb->bpp,
+            fvsi.red.length, fvsi.green.length, fvsi.blue.length);
         goto out;
-	}
+    }
+    fb->is_bgr  = (fvsi.red.offset > fvsi.blue.offset);
+    if ((fb->fmt = _fb_find_format(fb->bpp, fb->is_bgr)) == NULL) {
+        err("unsupported bits per pixel(%d)\n", fb->bpp);
+        goto out;
+    }
 
+    fb->size = ffsi.smem_len;
 	fb->base = (char *)mmap((caddr_t) NULL, ffsi.smem_len,
                         PROT_READ | PROT_WRITE, MAP_SHARED, fb->fd, 0);
 
@@ -382,7 +1448,10 @@ fb_info_t *fb_init (const char *DEVICE_NAME)
         goto out;
 	}
 
-    fb->data = fb->base + ((unsigned long) ffsi.smem_start % (unsigned long) getpagesize());
+    fb->page[0] = fb->base + ((unsigned long) ffsi.smem_start % (unsigned long) getpagesize());
+    fb->page[1] = fb->page[0] + (fb->stride * fb->h);
+    fb->vram = fb->page[fb->page_front];
+    fb->data = fb->vram;
     fb_clear(fb);
     return  fb;
 out:
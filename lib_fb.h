@@ -61,15 +61,72 @@ typedef union fb_color__u {
     unsigned int uint;
 }	fb_color_u;
 
+/*
+    pixel format backend (fb_init에서 framebuffer 정보에 맞게 선택됨)
+    pack      : 0xRRGGBB 색상 -> framebuffer pixel 값 변환
+    put       : pixel 1개 기록
+    fill_span : 같은 pixel 값으로 w 개 기록
+    glyph_row : glyph 1 line(msb first bits)을 scale 배율로 확대하여 기록
+    to_rgb    : pixel 1 line을 R,G,B 24bits 데이터로 변환 (화면 dump)
+*/
+typedef void (*glyph_row_func) (char *dst, unsigned int bits, int nbits, int scale,
+								int skip, int cnt, unsigned int fg, unsigned int bg);
+
+typedef struct fb_format__t {
+	const char		*name;
+	int				bpp, bypp;
+	bool			is_bgr;
+	unsigned int	(*pack)		(int color);
+	void			(*put)		(char *dst, unsigned int pixel);
+	void			(*fill_span)(char *dst, int w, unsigned int pixel);
+	glyph_row_func	glyph_row;
+	void			(*to_rgb)	(unsigned char *rgb, const char *src, int w);
+}	fb_format_t;
+
+typedef struct fb_rect__t {
+	int			x, y, w, h;
+}	fb_rect_t;
+
+/* shadow buffer 사용시 fb_flush 전까지 기록되는 변경 영역 최대 개수 */
+#define FB_DAMAGE_MAX	32
+/* fb_push_clip 으로 추가 가능한 clip 영역 최대 개수 */
+#define FB_CLIP_DEPTH	8
+
+/* framebuffer 종류 (fb_init의 DEVICE_NAME 형식에 따라 결정) */
+enum eFB_TYPE {
+	eFB_TYPE_DEV = 0,	/* /dev/fbX */
+	eFB_TYPE_MEM,		/* mem:{w}x{h}x{bpp} */
+	eFB_TYPE_FILE,		/* file:{path}:{w}x{h}x{bpp} */
+};
+
 typedef struct fb_info__t {
 	int			fd;
+	int			type;
 	int			w;
 	int			h;
 	int			stride;
 	int			bpp;
 	bool		is_bgr;
+	const fb_format_t	*fmt;
 	char		*base;
+	unsigned long	size;
+	/* 그리기 대상 메모리 (shadow 사용시 shadow, 아니면 vram) */
 	char		*data;
+	/* mmap 된 화면 메모리 (page flip 사용시 back page) */
+	char		*vram;
+	/* page flip (FBIOPAN_DISPLAY) 지원시 2, 아니면 1 */
+	int			page_cnt, page_front;
+	char		*page[2];
+	/* system ram 에 할당된 back buffer */
+	char		*shadow;
+	int			damage_cnt;
+	fb_rect_t	damage[FB_DAMAGE_MAX];
+	/* clip stack (clip[0] = 전체 화면, clip[clip_cnt] = 현재 clip 영역) */
+	int			clip_cnt;
+	fb_rect_t	clip[FB_CLIP_DEPTH + 1];
+	/* page flip 사용시 이전 frame의 변경 영역 및 전체 복사 횟수 */
+	int			prev_damage_cnt, flip_full;
+	fb_rect_t	prev_damage[FB_DAMAGE_MAX];
 }	fb_info_t;
 
 //-----------------------------------------------------------------------------
@@ -77,6 +134,12 @@ typedef struct fb_info__t {
 #define FONT_ASCII_WIDTH    8
 #define FONT_HEIGHT         16
 
+/* glyph 확대 최대 배율 */
+#define FB_SCALE_MAX        100
+
+/* 잘못된 UTF-8 sequence 대신 사용하는 code (빈 2칸 문자로 표시) */
+#define FB_UTF8_INVALID     0xFFFD
+
 enum eFONTS_HANGUL {
     eFONT_HAN_DEFAULT = 0,
     eFONT_HANBOOT,
@@ -94,8 +157,20 @@ extern void         draw_text 	(fb_info_t *fb, int x, int y,
 extern void         draw_line 	(fb_info_t *fb, int x, int y, int w, int color);
 extern void         draw_rect 	(fb_info_t *fb, int x, int y, int w, int h, int lw, int color);
 extern void         draw_fill_rect (fb_info_t *fb, int x, int y, int w, int h, int color);
+extern void         fb_move_rect (fb_info_t *fb, int sx, int sy, int w, int h,
+									int dx, int dy);
 extern void         set_font	(enum eFONTS_HANGUL s_font);
+extern unsigned int fb_utf8_decode (const char **p_str);
 extern void         fb_clear 	(fb_info_t *fb);
+extern bool         fb_push_clip (fb_info_t *fb, int x, int y, int w, int h);
+extern void         fb_pop_clip (fb_info_t *fb);
+extern void         fb_set_bgr 	(fb_info_t *fb, bool is_bgr);
+extern bool         fb_shadow_enable (fb_info_t *fb, bool enable);
+extern void         fb_flush 	(fb_info_t *fb);
+extern void         fb_glyph_cache_size (unsigned long max_bytes);
+extern void         fb_glyph_cache_stat (unsigned long *hit, unsigned long *miss,
+										unsigned long *used);
+extern bool         fb_dump 	(fb_info_t *fb, const char *filename);
 extern void         fb_close 	(fb_info_t *fb);
 extern fb_info_t    *fb_init 	(const char *DEVICE_NAME);
 
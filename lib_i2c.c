@@ -0,0 +1,725 @@
+//------------------------------------------------------------------------------
+/**
+ * @file lib_i2c.c
+ * @author charles-park (charles.park@hardkernel.com)
+ * @brief i2c-dev bus handle library.
+ * @version 0.1
+ * @date 2022-08-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//------------------------------------------------------------------------------
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#include "lib_i2c.h"
+
+//------------------------------------------------------------------------------
+/*
+    Bus handle pool
+    검사 주기마다 access/open/ioctl(I2C_SLAVE)/close 를 반복하지 않도록
+    adapter 별로 fd를 열어두고 I2C_FUNCS 결과와 선택된 slave 주소를 보관한다.
+    전송이 실패한 경우에만 node를 stat 하여 adapter가 없어졌는지 확인한다.
+    handle은 하나씩 할당하므로 pool이 커져도 이미 넘겨준 포인터는 바뀌지 않는다.
+*/
+static i2c_bus_t    **I2cBus = NULL;
+static int          I2cBusCnt = 0, I2cBusMax = 0;
+
+/* i2c_scan : bus 별 scan thread 인자 및 결과 */
+typedef struct i2c_scan__t {
+    i2c_bus_t   *bus;
+    i2c_map_t   *map;
+    int         found;
+}   i2c_scan_t;
+
+//------------------------------------------------------------------------------
+// Function prototype.
+//------------------------------------------------------------------------------
+static  bool    _i2c_bus_reopen (i2c_bus_t *bus);
+static  bool    _i2c_bus_gone   (i2c_bus_t *bus);
+static  int     _i2c_bus_slave  (i2c_bus_t *bus, __u8 addr);
+static  void    *_i2c_scan_thread (void *arg);
+static  __u64   _i2c_ns         (void);
+static  void    _i2c_lat_add    (i2c_lat_t *lat, __u64 ns);
+static  __u32   _i2c_lat_upper  (int idx);
+static  __s32   _i2c_bus_xfer   (i2c_bus_t *bus, int op, char read_write, __u8 cmd,
+                                 int size, union i2c_smbus_data *data);
+static  __s32   _i2c_bus_error  (i2c_bus_t *bus, __s32 ret);
+static  void    *_i2c_soak_thread (void *arg);
+
+//------------------------------------------------------------------------------
+__s32 i2c_smbus_access(int file, char read_write, __u8 command,
+               int size, union i2c_smbus_data *data)
+{
+    struct i2c_smbus_ioctl_data args;
+    __s32 err;
+
+    args.read_write = read_write;
+    args.command = command;
+    args.size = size;
+    args.data = data;
+
+    err = ioctl(file, I2C_SMBUS, &args);
+    if (err == -1)
+        err = -errno;
+    return err;
+}
+
+//------------------------------------------------------------------------------
+/*
+    전송 latency 측정
+    NTP 보정의 영향을 받지 않도록 CLOCK_MONOTONIC_RAW를 사용한다. (vDSO, syscall 없음)
+*/
+static __u64 _i2c_ns (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (__u64)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//------------------------------------------------------------------------------
+/*
+    histogram 기록 (나눗셈, 잠금 없이 clz 한번으로 칸을 구한다)
+    v < 4 : v 번째 칸, 그 외 : 최상위 bit(msb)와 그 아래 2 bit로 구분
+*/
+static void _i2c_lat_add (i2c_lat_t *lat, __u64 ns)
+{
+    __u64 v = ns >> I2C_LAT_SHIFT;
+    int idx, msb;
+
+    if (v < 4)
+        idx = (int)v;
+    else {
+        msb = 63 - __builtin_clzll(v);
+        idx = ((msb - 1) << 2) | (int)((v >> (msb - 2)) & 3);
+        if (idx >= I2C_LAT_BUCKETS)
+            idx = I2C_LAT_BUCKETS -1;
+    }
+    lat->bucket[idx]++;
+    lat->cnt++;
+    if (ns > lat->max)
+        lat->max = (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (__u32)ns;
+}
+
+//------------------------------------------------------------------------------
+/* idx 칸의 상한 (ns) */
+static __u32 _i2c_lat_upper (int idx)
+{
+    int msb = (idx >> 2) + 1, sub = idx & 3;
+
+    if (idx < 4)
+        return (__u32)(idx + 1) << I2C_LAT_SHIFT;
+    return (__u32)((__u64)(4 + sub + 1) << (msb - 2 + I2C_LAT_SHIFT));
+}
+
+//------------------------------------------------------------------------------
+/*
+    현재 선택된 slave 주소로 smbus 전송 후 걸린 시간을 (주소, 전송 종류) histogram에 기록
+    실패한 전송(NACK, timeout)도 기록한다.
+*/
+static __s32 _i2c_bus_xfer (i2c_bus_t *bus, int op, char read_write, __u8 cmd,
+                            int size, union i2c_smbus_data *data)
+{
+    __u64 start = _i2c_ns();
+    __s32 ret = i2c_smbus_access(bus->fd, read_write, cmd, size, data);
+
+    __u64 ns  = _i2c_ns() - start;
+
+    bus->last_ns = (ns > 0xFFFFFFFFULL) ? 0xFFFFFFFF : (__u32)ns;
+    if (bus->lat && (bus->addr >= 0))
+        _i2c_lat_add(&bus->lat[bus->addr * eI2C_OP_END + op], ns);
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+static bool _i2c_bus_reopen (i2c_bus_t *bus)
+{
+    struct stat st;
+
+    if (bus->fd >= 0)
+        return true;
+
+    if ((bus->fd = open(bus->node, O_RDWR | O_CLOEXEC)) < 0)
+        return false;
+
+    if ((fstat(bus->fd, &st) < 0) || (ioctl(bus->fd, I2C_FUNCS, &bus->funcs) < 0)) {
+        err("%s : I2C_FUNCS fail (%s)\n", bus->node, strerror(errno));
+        close(bus->fd);
+        bus->fd = -1;
+        return false;
+    }
+    bus->rdev = st.st_rdev;     bus->ino  = st.st_ino;
+    bus->addr = -1;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/*
+    전송이 실패한 경우 호출한다.
+    node가 없어졌거나 open 이후 다시 만들어진 경우(driver reload) fd를 닫고
+    다음 호출에서 다시 open 하도록 한다.
+*/
+static bool _i2c_bus_gone (i2c_bus_t *bus)
+{
+    struct stat st;
+
+    if ((stat(bus->node, &st) == 0) &&
+        (st.st_rdev == bus->rdev) && (st.st_ino == bus->ino))
+        return false;
+
+    info("%s : adapter removed or replaced, reopen.\n", bus->node);
+    i2c_bus_close(bus);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/*
+    node 이름으로 열려있는 handle을 찾고, 없으면 pool에 추가하여 open 한다.
+    node를 open 할 수 없는 경우 NULL (다음 호출시 다시 시도)
+*/
+i2c_bus_t *i2c_bus_open (const char *node)
+{
+    i2c_bus_t *bus = NULL;
+    int i;
+
+    for (i = 0; i < I2cBusCnt; i++) {
+        if (!strncmp(I2cBus[i]->node, node, sizeof(I2cBus[i]->node))) {
+            bus = I2cBus[i];
+            break;
+        }
+    }
+    if (bus == NULL) {
+        if (I2cBusCnt >= I2cBusMax) {
+            int max = I2cBusMax ? I2cBusMax * 2 : I2C_BUS_MAX;
+            i2c_bus_t **pool = (i2c_bus_t **)realloc(I2cBus, max * sizeof(i2c_bus_t *));
+
+            if (pool == NULL) {
+                err("%s : i2c bus pool alloc fail\n", node);
+                return NULL;
+            }
+            I2cBus = pool;  I2cBusMax = max;
+        }
+        if ((bus = (i2c_bus_t *)calloc(1, sizeof(i2c_bus_t))) == NULL) {
+            err("%s : i2c bus alloc fail\n", node);
+            return NULL;
+        }
+        /* 고정 크기 : adapter 당 약 136KB (사용한 주소의 page만 실제로 할당됨) */
+        if ((bus->lat = (i2c_lat_t *)calloc(I2C_ADDR_MAX * eI2C_OP_END,
+                                            sizeof(i2c_lat_t))) == NULL)
+            err("%s : latency histogram alloc fail\n", node);
+        I2cBus[I2cBusCnt++] = bus;
+        strncpy(bus->node, node, sizeof(bus->node) -1);
+        bus->fd = -1;   bus->addr = -1;
+    }
+    return _i2c_bus_reopen(bus) ? bus : NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+    slave 주소가 바뀐 경우에만 I2C_SLAVE를 설정한다.
+*/
+static int _i2c_bus_slave (i2c_bus_t *bus, __u8 addr)
+{
+    if (!_i2c_bus_reopen(bus))
+        return -ENODEV;
+
+    if (bus->addr == addr)
+        return 0;
+
+    if (ioctl(bus->fd, I2C_SLAVE, addr) < 0) {
+        int ret = -errno;
+
+        bus->addr = -1;
+        /* EBUSY = kernel driver가 사용중인 주소 */
+        return ((ret != -EBUSY) && _i2c_bus_gone(bus)) ? -ENODEV : ret;
+    }
+    bus->addr = addr;
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+    slave 주소 설정. 실패 원인은 출력하지 않는다. (호출한 곳에서 필요한 경우 출력)
+    전송 함수들은 I2C_SLAVE 실패시 -errno(EBUSY 등)를 그대로 반환한다.
+*/
+bool i2c_bus_select (i2c_bus_t *bus, __u8 addr)
+{
+    return (_i2c_bus_slave(bus, addr) == 0);
+}
+
+//------------------------------------------------------------------------------
+/*
+    addr device에서 1 byte를 읽는다. (smbus receive byte)
+    성공하면 읽은 값(0 ~ 255), 실패하면 -errno
+*/
+__s32 i2c_bus_read_byte (i2c_bus_t *bus, __u8 addr)
+{
+    union i2c_smbus_data data;
+    __s32 ret;
+
+    if ((ret = _i2c_bus_slave(bus, addr)) < 0)
+        return ret;
+
+    if (!(bus->funcs & I2C_FUNC_SMBUS_READ_BYTE))
+        return -EOPNOTSUPP;
+
+    if ((ret = _i2c_bus_xfer(bus, eI2C_OP_READ_BYTE, I2C_SMBUS_READ, 0,
+                             I2C_SMBUS_BYTE, &data)) < 0)
+        return _i2c_bus_error(bus, ret);
+    return data.byte;
+}
+
+//------------------------------------------------------------------------------
+/*
+    전송 실패 처리
+    응답이 없는 경우(NACK)는 device 문제이므로 adapter가 없어졌는지 확인하지 않는다.
+    adapter가 없어진 경우 -ENODEV
+*/
+static __s32 _i2c_bus_error (i2c_bus_t *bus, __s32 ret)
+{
+    if ((ret != -ENXIO) && (ret != -EREMOTEIO) && _i2c_bus_gone(bus))
+        return -ENODEV;
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+/* smbus quick write. 성공하면 0, 실패하면 -errno */
+__s32 i2c_bus_quick (i2c_bus_t *bus, __u8 addr)
+{
+    __s32 ret;
+
+    if ((ret = _i2c_bus_slave(bus, addr)) < 0)
+        return ret;
+
+    if (!(bus->funcs & I2C_FUNC_SMBUS_QUICK))
+        return -EOPNOTSUPP;
+
+    if ((ret = _i2c_bus_xfer(bus, eI2C_OP_QUICK, I2C_SMBUS_WRITE, 0,
+                             I2C_SMBUS_QUICK, NULL)) < 0)
+        return _i2c_bus_error(bus, ret);
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+/* smbus read word data (cmd = register). 성공하면 읽은 값(0 ~ 65535), 실패하면 -errno */
+__s32 i2c_bus_read_word (i2c_bus_t *bus, __u8 addr, __u8 cmd)
+{
+    union i2c_smbus_data data;
+    __s32 ret;
+
+    if ((ret = _i2c_bus_slave(bus, addr)) < 0)
+        return ret;
+
+    if (!(bus->funcs & I2C_FUNC_SMBUS_READ_WORD_DATA))
+        return -EOPNOTSUPP;
+
+    if ((ret = _i2c_bus_xfer(bus, eI2C_OP_READ_WORD, I2C_SMBUS_READ, cmd,
+                             I2C_SMBUS_WORD_DATA, &data)) < 0)
+        return _i2c_bus_error(bus, ret);
+    return data.word;
+}
+
+//------------------------------------------------------------------------------
+/*
+    cmd(register) 부터 len byte를 읽는다. (i2c block read, 한번의 repeated start 전송)
+    smbus block read와 달리 device가 길이를 보내지 않아도 되므로 대부분의 device에서 동작한다.
+    성공하면 읽은 byte 수, 실패하면 -errno
+*/
+__s32 i2c_bus_read_block (i2c_bus_t *bus, __u8 addr, __u8 cmd, __u8 *buf, int len)
+{
+    union i2c_smbus_data data;
+    __s32 ret;
+
+    if ((len < 1) || (len > I2C_SMBUS_BLOCK_MAX))
+        return -EINVAL;
+
+    if ((ret = _i2c_bus_slave(bus, addr)) < 0)
+        return ret;
+
+    if (!(bus->funcs & I2C_FUNC_SMBUS_READ_I2C_BLOCK))
+        return -EOPNOTSUPP;
+
+    data.block[0] = len;
+    if ((ret = _i2c_bus_xfer(bus, eI2C_OP_READ_BLOCK, I2C_SMBUS_READ, cmd,
+                             I2C_SMBUS_I2C_BLOCK_DATA, &data)) < 0)
+        return _i2c_bus_error(bus, ret);
+
+    if (data.block[0] < len)
+        len = data.block[0];
+    memcpy(buf, &data.block[1], len);
+    return len;
+}
+
+//------------------------------------------------------------------------------
+/*
+    addr에 device가 있는지 확인한다. (i2cdetect auto mode와 같은 방법)
+    0x30~0x37, 0x50~0x5F 는 write에 반응하는 EEPROM 등이 있어 read byte,
+    나머지 주소는 quick write로 확인한다.
+    kernel driver가 사용중인 주소(I2C_SLAVE = EBUSY)는 device가 있는 것으로 본다.
+    반환값 : 1 = 있음, 0 = 없음, -errno = 확인할 수 없음
+*/
+int i2c_bus_probe (i2c_bus_t *bus, __u8 addr)
+{
+    union i2c_smbus_data data;
+    bool read = ((addr >= 0x30) && (addr <= 0x37)) || ((addr >= 0x50) && (addr <= 0x5F));
+    int ret;
+
+    if ((ret = _i2c_bus_slave(bus, addr)) < 0)
+        return (ret == -EBUSY) ? 1 : ret;
+
+    if (!(bus->funcs & (read ? I2C_FUNC_SMBUS_READ_BYTE : I2C_FUNC_SMBUS_QUICK)))
+        return -EOPNOTSUPP;
+
+    if (read)
+        ret = _i2c_bus_xfer(bus, eI2C_OP_READ_BYTE, I2C_SMBUS_READ, 0, I2C_SMBUS_BYTE, &data);
+    else
+        ret = _i2c_bus_xfer(bus, eI2C_OP_QUICK, I2C_SMBUS_WRITE, 0, I2C_SMBUS_QUICK, NULL);
+
+    /* 응답이 없는 주소(NACK)는 정상적인 결과이므로 adapter를 확인하지 않는다. */
+    if (ret < 0)
+        return ((ret != -ENXIO) && (ret != -EREMOTEIO) && _i2c_bus_gone(bus)) ? -ENODEV : 0;
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+/*
+    I2C_SCAN_FIRST ~ I2C_SCAN_LAST 주소를 확인하여 map에 저장한다.
+    반환값 : 찾은 device 수, adapter를 사용할 수 없는 경우 -ENODEV
+    (adapter가 지원하지 않는 방법으로 확인해야 하는 주소는 없는 것으로 표시)
+*/
+int i2c_bus_scan (i2c_bus_t *bus, i2c_map_t *map)
+{
+    int addr, ret, found = 0;
+
+    memset(map, 0x00, sizeof(i2c_map_t));
+    for (addr = I2C_SCAN_FIRST; addr <= I2C_SCAN_LAST; addr++) {
+        if ((ret = i2c_bus_probe(bus, addr)) == -ENODEV)
+            return -ENODEV;
+        if (ret > 0) {
+            I2C_MAP_SET(map, addr);
+            found++;
+        }
+    }
+    return found;
+}
+
+//------------------------------------------------------------------------------
+static void *_i2c_scan_thread (void *arg)
+{
+    i2c_scan_t *scan = (i2c_scan_t *)arg;
+
+    scan->found = i2c_bus_scan(scan->bus, scan->map);
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+    adapter 들은 서로 독립된 bus이므로 bus 마다 thread를 만들어 동시에 scan 한다.
+    bus[i] == NULL 이면 map[i]는 비우고 found[i] = -ENODEV
+    (thread를 만들 수 없으면 호출한 thread에서 scan)
+*/
+void i2c_scan (i2c_bus_t **bus, int cnt, i2c_map_t *map, int *found)
+{
+    i2c_scan_t  *scan;
+    pthread_t   *tid;
+    bool        *run;
+    int i;
+
+    scan = (i2c_scan_t *)calloc(cnt, sizeof(i2c_scan_t));
+    tid  = (pthread_t  *)calloc(cnt, sizeof(pthread_t));
+    run  = (bool       *)calloc(cnt, sizeof(bool));
+
+    for (i = 0; i < cnt; i++) {
+        /* 할당 실패시 thread 없이 순서대로 scan */
+        if (!scan || !tid || !run) {
+            found[i] = bus[i] ? i2c_bus_scan(bus[i], &map[i]) : -ENODEV;
+            if (bus[i] == NULL)
+                memset(&map[i], 0x00, sizeof(i2c_map_t));
+            continue;
+        }
+        scan[i].bus = bus[i];   scan[i].map = &map[i];  scan[i].found = -ENODEV;
+        if (bus[i] == NULL) {
+            memset(&map[i], 0x00, sizeof(i2c_map_t));
+            continue;
+        }
+        /* 마지막 bus는 호출한 thread에서 scan */
+        if (i < cnt -1)
+            run[i] = (pthread_create(&tid[i], NULL, _i2c_scan_thread, &scan[i]) == 0);
+        if (!run[i])
+            _i2c_scan_thread(&scan[i]);
+    }
+    for (i = 0; (i < cnt) && scan && tid && run; i++) {
+        if (run[i])
+            pthread_join(tid[i], NULL);
+        found[i] = scan[i].found;
+    }
+    free(scan); free(tid);  free(run);
+}
+
+//------------------------------------------------------------------------------
+void i2c_bus_close (i2c_bus_t *bus)
+{
+    if (bus->fd >= 0)
+        close(bus->fd);
+    bus->fd = -1;   bus->addr = -1;
+}
+
+//------------------------------------------------------------------------------
+/*
+    모든 handle을 닫고 pool을 비운다. (검사 대상 설정이 바뀐 경우)
+    이전에 받은 i2c_bus_t 포인터는 더 이상 사용할 수 없다.
+*/
+void i2c_bus_close_all (void)
+{
+    int i;
+
+    for (i = 0; i < I2cBusCnt; i++) {
+        i2c_bus_close(I2cBus[i]);
+        free(I2cBus[i]->lat);
+        free(I2cBus[i]);
+    }
+    free(I2cBus);
+    I2cBus = NULL;
+    I2cBusCnt = I2cBusMax = 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+    node의 handle을 닫고 pool에서 뺀다. (검사 대상에서 빠진 adapter)
+    남아있는 adapter의 handle과 latency histogram은 그대로 유지된다.
+*/
+void i2c_bus_remove (const char *node)
+{
+    int i;
+
+    for (i = 0; i < I2cBusCnt; i++) {
+        if (strncmp(I2cBus[i]->node, node, sizeof(I2cBus[i]->node)))
+            continue;
+        i2c_bus_close(I2cBus[i]);
+        free(I2cBus[i]->lat);
+        free(I2cBus[i]);
+        I2cBus[i] = I2cBus[--I2cBusCnt];
+        return;
+    }
+}
+
+//------------------------------------------------------------------------------
+/* addr, op의 latency histogram (없으면 NULL) */
+i2c_lat_t *i2c_bus_lat (i2c_bus_t *bus, __u8 addr, int op)
+{
+    if ((bus == NULL) || (bus->lat == NULL) || (addr >= I2C_ADDR_MAX) ||
+        (op < 0) || (op >= eI2C_OP_END))
+        return NULL;
+    return &bus->lat[addr * eI2C_OP_END + op];
+}
+
+//------------------------------------------------------------------------------
+/* 여러 주소(또는 전송 종류)의 histogram을 합친다. */
+void i2c_lat_merge (i2c_lat_t *dst, const i2c_lat_t *src)
+{
+    int i;
+
+    for (i = 0; i < I2C_LAT_BUCKETS; i++)
+        dst->bucket[i] += src->bucket[i];
+    dst->cnt += src->cnt;
+    if (src->max > dst->max)
+        dst->max = src->max;
+}
+
+//------------------------------------------------------------------------------
+/*
+    pct % 위치의 latency (ns, 해당 칸의 상한, 최대값보다 크지 않음)
+    기록된 전송이 없으면 0
+*/
+__u32 i2c_lat_pct (const i2c_lat_t *lat, int pct)
+{
+    __u64 rank, sum = 0;
+    __u32 upper;
+    int i;
+
+    if (!lat->cnt)
+        return 0;
+
+    /* 기록 중인 값을 읽는 경우 cnt와 bucket 합이 다를 수 있으므로 bucket 합을 기준으로 한다. */
+    for (i = 0; i < I2C_LAT_BUCKETS; i++)
+        sum += lat->bucket[i];
+    rank = (sum * pct + 99) / 100;
+    if (rank == 0)
+        rank = 1;
+
+    for (i = 0, sum = 0; i < I2C_LAT_BUCKETS; i++) {
+        if ((sum += lat->bucket[i]) >= rank)
+            break;
+    }
+    upper = (i < I2C_LAT_BUCKETS -1) ? _i2c_lat_upper(i) : lat->max;
+    return (upper < lat->max) ? upper : lat->max;
+}
+
+//------------------------------------------------------------------------------
+const char *i2c_op_name (int op)
+{
+    static const char *name[eI2C_OP_END] = {
+        "quick", "read_byte", "read_word", "read_block"
+    };
+    return ((op >= 0) && (op < eI2C_OP_END)) ? name[op] : "unknown";
+}
+
+//------------------------------------------------------------------------------
+/*
+    열려있는 모든 adapter의 latency histogram을 path에 text로 저장한다.
+    (임시 파일에 쓴 후 rename 하므로 읽는 쪽은 항상 완성된 파일을 본다)
+    node addr op cnt p50 p99 max (us), 이후 기록된 칸의 "상한(us):개수" (마지막 칸 = inf)
+*/
+bool i2c_lat_export (const char *path)
+{
+    char tmp[PATH_MAX];
+    FILE *fp;
+    int i, addr, op, b;
+    i2c_lat_t *lat;
+
+    snprintf(tmp, sizeof(tmp), "%s.tmp", path);
+    if ((fp = fopen(tmp, "w")) == NULL) {
+        err("%s : open fail (%s)\n", tmp, strerror(errno));
+        return false;
+    }
+    fprintf(fp, "# node addr op cnt p50_us p99_us max_us [bucket_upper_us:cnt ...]\n");
+    for (i = 0; i < I2cBusCnt; i++) {
+        if (I2cBus[i]->lat == NULL)
+            continue;
+        for (addr = 0; addr < I2C_ADDR_MAX; addr++) {
+            for (op = 0; op < eI2C_OP_END; op++) {
+                lat = &I2cBus[i]->lat[addr * eI2C_OP_END + op];
+                if (!lat->cnt)
+                    continue;
+                fprintf(fp, "%s 0x%02x %s %u %.1f %.1f %.1f", I2cBus[i]->node, addr,
+                        i2c_op_name(op), lat->cnt,
+                        i2c_lat_pct(lat, 50) / 1000.0, i2c_lat_pct(lat, 99) / 1000.0,
+                        lat->max / 1000.0);
+                for (b = 0; b < I2C_LAT_BUCKETS -1; b++)
+                    if (lat->bucket[b])
+                        fprintf(fp, " %.1f:%u", _i2c_lat_upper(b) / 1000.0, lat->bucket[b]);
+                if (lat->bucket[b])
+                    fprintf(fp, " inf:%u", lat->bucket[b]);
+                fprintf(fp, "\n");
+            }
+        }
+    }
+    if ((fclose(fp) != 0) || (rename(tmp, path) != 0)) {
+        err("%s : write fail (%s)\n", path, strerror(errno));
+        unlink(tmp);
+        return false;
+    }
+    return true;
+}
+
+//------------------------------------------------------------------------------
+/* 다른 thread가 잠금 없이 읽는 결과 값 (쓰는 thread는 하나뿐이므로 lock 없는 load/store) */
+#define SOAK_ADD(v, n)  __atomic_store_n(&(v), (v) + (n), __ATOMIC_RELAXED)
+
+static void *_i2c_soak_thread (void *arg)
+{
+    i2c_soak_t *soak = (i2c_soak_t *)arg;
+    __u8 list[I2C_ADDR_MAX], buf[I2C_SMBUS_BLOCK_MAX];
+    int mix[eI2C_OP_END], cnt = 0, total = 0, addr, op, i, n;
+    __u32 rnd = 0x9E3779B9;
+    __s32 ret;
+
+    for (addr = 0; addr < I2C_ADDR_MAX; addr++)
+        if (I2C_MAP_TEST(&soak->addr, addr))
+            list[cnt++] = addr;
+    for (op = 0; op < eI2C_OP_END; op++)
+        total += mix[op] = (soak->mix[op] > 0) ? soak->mix[op] : 0;
+    if (!cnt || !total)
+        return NULL;
+
+    for (i = 0; !__atomic_load_n(&soak->stop, __ATOMIC_RELAXED); i = (i + 1) % cnt) {
+        /* 전송 종류 선택 (xorshift32, mix 비율) */
+        rnd ^= rnd << 13;   rnd ^= rnd >> 17;   rnd ^= rnd << 5;
+        for (op = 0, n = rnd % total; n >= mix[op]; op++)
+            n -= mix[op];
+
+        switch (op) {
+            case eI2C_OP_QUICK:
+                ret = i2c_bus_quick(soak->bus, list[i]);    n = 0;
+                break;
+            case eI2C_OP_READ_BYTE:
+                ret = i2c_bus_read_byte(soak->bus, list[i]);    n = 1;
+                break;
+            case eI2C_OP_READ_WORD:
+                ret = i2c_bus_read_word(soak->bus, list[i], 0); n = 2;
+                break;
+            default :
+                ret = n = i2c_bus_read_block(soak->bus, list[i], 0, buf, soak->block_len);
+                break;
+        }
+        SOAK_ADD(soak->xfer, 1);
+        if (ret < 0) {
+            SOAK_ADD(soak->errs, 1);
+            n = (-ret < I2C_SOAK_ERRNO_MAX) ? -ret : I2C_SOAK_ERRNO_MAX -1;
+            SOAK_ADD(soak->err[n], 1);
+            /* adapter가 없어진 경우 다시 생길 때까지 쉬면서 시도 */
+            if (ret == -ENODEV)
+                usleep(100000);
+        }
+        else
+            SOAK_ADD(soak->bytes, n);
+    }
+    return NULL;
+}
+
+//------------------------------------------------------------------------------
+/*
+    soak thread 시작 (soak->bus, addr, mix, block_len 은 미리 설정)
+    결과는 0부터 다시 센다. 주소가 없거나 mix가 모두 0이면 false
+*/
+bool i2c_soak_start (i2c_soak_t *soak)
+{
+    int i, total = 0;
+
+    soak->xfer = soak->bytes = soak->errs = 0;
+    memset(soak->err, 0x00, sizeof(soak->err));
+    soak->stop = false;
+    soak->run  = false;
+
+    if (soak->bus == NULL)
+        return false;
+
+    /* 전송할 주소나 전송 종류가 없으면 thread가 바로 끝나므로 시작하지 않는다. */
+    for (i = 0; i < eI2C_OP_END; i++)
+        total += (soak->mix[i] > 0) ? soak->mix[i] : 0;
+    if (!total || !(soak->addr.bits[0] | soak->addr.bits[1])) {
+        err("%s : soak has no address or transfer mix!\n", soak->bus->node);
+        return false;
+    }
+
+    if (pthread_create(&soak->tid, NULL, _i2c_soak_thread, soak) != 0) {
+        err("%s : soak thread create fail!\n", soak->bus->node);
+        return false;
+    }
+    return (soak->run = true);
+}
+
+//------------------------------------------------------------------------------
+void i2c_soak_stop (i2c_soak_t *soak)
+{
+    if (!soak->run)
+        return;
+    __atomic_store_n(&soak->stop, true, __ATOMIC_RELAXED);
+    pthread_join(soak->tid, NULL);
+    soak->run = false;
+}
+
+//------------------------------------------------------------------------------
+//------------------------------------------------------------------------------
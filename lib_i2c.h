@@ -0,0 +1,145 @@
+//-----------------------------------------------------------------------------
+/**
+ * @file lib_i2c.h
+ * @author charles-park (charles-park@hardkernel.com)
+ * @brief i2c-dev bus handle library header file.
+ * @version 0.1
+ * @date 2022-08-25
+ *
+ * @copyright Copyright (c) 2022
+ *
+ */
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
+#ifndef __LIB_I2C_H__
+#define __LIB_I2C_H__
+
+//-----------------------------------------------------------------------------
+#include <pthread.h>
+#include <sys/types.h>
+#include <linux/i2c.h>
+#include <linux/i2c-dev.h>
+
+#include "typedefs.h"
+
+//-----------------------------------------------------------------------------
+/* handle pool의 처음 크기 (adapter가 더 있으면 2배씩 늘린다) */
+#define I2C_BUS_MAX         8
+#define I2C_BUS_NAME_MAX    32
+
+/* 7bit 주소 범위 및 scan 범위 (i2cdetect 기본 범위, 예약 주소 제외) */
+#define I2C_ADDR_MAX        128
+#define I2C_SCAN_FIRST      0x03
+#define I2C_SCAN_LAST       0x77
+
+//-----------------------------------------------------------------------------
+/* 주소별 device 존재 여부 (128 bit) */
+typedef struct i2c_map__t {
+    unsigned long long  bits[I2C_ADDR_MAX / 64];
+}   i2c_map_t;
+
+#define I2C_MAP_SET(m, a)   ((m)->bits[(a) >> 6] |=  (1ULL << ((a) & 63)))
+#define I2C_MAP_CLR(m, a)   ((m)->bits[(a) >> 6] &= ~(1ULL << ((a) & 63)))
+#define I2C_MAP_TEST(m, a)  (((m)->bits[(a) >> 6] >> ((a) & 63)) & 1)
+
+//-----------------------------------------------------------------------------
+/* 전송 종류 (latency histogram 구분) */
+enum i2c_op__e {
+    eI2C_OP_QUICK = 0,      /* smbus quick write (probe) */
+    eI2C_OP_READ_BYTE,      /* smbus receive byte        */
+    eI2C_OP_READ_WORD,      /* smbus read word data      */
+    eI2C_OP_READ_BLOCK,     /* smbus/i2c block read      */
+    eI2C_OP_END
+};
+
+/*
+    전송 latency histogram (log-linear, 고정 크기)
+    단위 = 1024 ns, 0 ~ 3 은 1칸씩, 그 이상은 2배 마다 4칸 (칸 폭 약 19%)
+    마지막 칸(63)은 7 << 14 단위(약 117 ms) 이상 모두. 최대값은 ns 단위로 따로 보관한다.
+*/
+#define I2C_LAT_SHIFT       10
+#define I2C_LAT_BUCKETS     64
+
+typedef struct i2c_lat__t {
+    __u32   cnt, max;
+    __u32   bucket[I2C_LAT_BUCKETS];
+}   i2c_lat_t;
+
+//-----------------------------------------------------------------------------
+/*
+    adapter 마다 한번만 open 하여 fd를 계속 사용한다.
+    node가 없어지거나(hotplug, driver reload) 다른 device로 바뀐 경우
+    다음 호출시 다시 open 한다.
+*/
+typedef struct i2c_bus__t {
+    char            node[I2C_BUS_NAME_MAX];
+    int             fd;
+    /* open시 읽은 I2C_FUNCS 결과 */
+    unsigned long   funcs;
+    /* 현재 I2C_SLAVE로 설정된 주소 (-1 = 설정되지 않음) */
+    int             addr;
+    /* open한 node의 device 번호 및 inode (node가 바뀌었는지 확인) */
+    dev_t           rdev;
+    ino_t           ino;
+    /*
+        전송 latency : lat[addr * eI2C_OP_END + op] (pool 추가시 할당, 없으면 NULL)
+        bus를 사용하는 thread만 기록하고, 읽는 쪽은 잠금 없이 읽는다.
+        last_ns = 마지막 전송의 latency
+    */
+    i2c_lat_t       *lat;
+    __u32           last_ns;
+}   i2c_bus_t;
+
+//-----------------------------------------------------------------------------
+/*
+    soak (burn-in) : bus 마다 thread 하나가 addr의 device들에 쉬지 않고 전송한다.
+    mix = 전송 종류별 비율 (0 = 사용하지 않음), block_len = block read 크기 (1 ~ 32)
+    결과는 thread만 더하고(relaxed atomic) 다른 thread는 잠금 없이 읽는다.
+    latency는 bus의 histogram(i2c_bus_lat)에 같이 기록된다.
+*/
+#define I2C_SOAK_ERRNO_MAX  128
+
+typedef struct i2c_soak__t {
+    /* 설정 (i2c_soak_start 전에 채움) */
+    i2c_bus_t       *bus;
+    i2c_map_t       addr;
+    int             mix[eI2C_OP_END];
+    int             block_len;
+
+    /* thread 제어 */
+    pthread_t       tid;
+    bool            run, stop;
+
+    /* 결과 : 전송 수, 읽은 byte 수, 실패 수 및 errno 별 실패 수 (마지막 칸은 그 외) */
+    __u64           xfer, bytes, errs;
+    __u32           err[I2C_SOAK_ERRNO_MAX];
+}   i2c_soak_t;
+
+//-----------------------------------------------------------------------------
+extern  __s32       i2c_smbus_access    (int file, char read_write, __u8 command,
+                                         int size, union i2c_smbus_data *data);
+extern  i2c_bus_t   *i2c_bus_open       (const char *node);
+extern  bool        i2c_bus_select      (i2c_bus_t *bus, __u8 addr);
+extern  __s32       i2c_bus_read_byte   (i2c_bus_t *bus, __u8 addr);
+extern  __s32       i2c_bus_quick       (i2c_bus_t *bus, __u8 addr);
+extern  __s32       i2c_bus_read_word   (i2c_bus_t *bus, __u8 addr, __u8 cmd);
+extern  __s32       i2c_bus_read_block  (i2c_bus_t *bus, __u8 addr, __u8 cmd,
+                                         __u8 *buf, int len);
+extern  int         i2c_bus_probe       (i2c_bus_t *bus, __u8 addr);
+extern  int         i2c_bus_scan        (i2c_bus_t *bus, i2c_map_t *map);
+extern  void        i2c_scan            (i2c_bus_t **bus, int cnt, i2c_map_t *map, int *found);
+extern  void        i2c_bus_close       (i2c_bus_t *bus);
+extern  void        i2c_bus_close_all   (void);
+extern  void        i2c_bus_remove      (const char *node);
+extern  i2c_lat_t   *i2c_bus_lat        (i2c_bus_t *bus, __u8 addr, int op);
+extern  void        i2c_lat_merge       (i2c_lat_t *dst, const i2c_lat_t *src);
+extern  __u32       i2c_lat_pct         (const i2c_lat_t *lat, int pct);
+extern  const char  *i2c_op_name        (int op);
+extern  bool        i2c_lat_export      (const char *path);
+extern  bool        i2c_soak_start      (i2c_soak_t *soak);
+extern  void        i2c_soak_stop       (i2c_soak_t *soak);
+
+//-----------------------------------------------------------------------------
+#endif  // #define __LIB_I2C_H__
+//-----------------------------------------------------------------------------
+//-----------------------------------------------------------------------------
@@ -29,24 +29,111 @@
 
 #include "lib_ui.h"
 
+//------------------------------------------------------------------------------
+/*
+   Layout cache
+   config 파일을 해석하여 배치(pixel 좌표, auto scale, 문자열 위치)가 끝난
+   ui_grp 메모리를 그대로 "<config 파일>.cache" 에 저장한다.
+   다음 실행시 config 내용의 hash와 fb 해상도가 같다면 cache 파일을 mmap하여
+   ui_grp로 사용한다. (환경변수 UI_NO_CACHE 가 설정되면 사용하지 않음)
+*/
+//------------------------------------------------------------------------------
+#define  UI_CACHE_EXT      ".cache"
+#define  UI_CACHE_MAGIC    "ODUI-LC1"
+/*
+   config 해석 방법, 배치 계산, widget data 형식이 바뀌면 증가시킨다.
+   (구조체 크기가 같더라도 이전 실행 파일이 만든 cache를 사용하지 않도록)
+*/
+#define  UI_CACHE_VERSION  2
+
+typedef struct ui_cache__t {
+   char     magic[8];
+   __u32    version;
+   __u32    hash, cfg_size;
+   int      w, h;
+   /* 구조체가 바뀐 경우 cache를 사용하지 않음 */
+   int      grp_size, r_size, s_size, w_size;
+   /* cache 헤더 뒤의 ui_grp 영역 크기 */
+   int      size;
+   /* 헤더 바로 뒤에 ui_grp가 위치하므로 pointer 크기 단위로 정렬 */
+}  __attribute__((aligned(sizeof(void *)))) ui_cache_t;
+
+/* ui_load 마다 증가 (ui_grp_t.serial) */
+static __u32 UiSerial = 0;
+
+/* W command의 widget 종류 이름 (enum eUI_WIDGET 순서) */
+static const char *UiWidgetName[eWIDGET_END] = { "LOG", "SPARK", "HIST", "GRID" };
+
 //------------------------------------------------------------------------------
 // Function prototype.
 //------------------------------------------------------------------------------
 static   r_item_t    *_ui_find_r_item  (ui_grp_t *ui_grp, int *sid, int fid);
 static   s_item_t    *_ui_find_s_item  (ui_grp_t *ui_grp, int *sid, int fid);
+static   void        _ui_build_index   (ui_grp_t *ui_grp);
+static   bool        _ui_is_extra      (ui_grp_t *ui_grp, int id);
+static   bool        _ui_count_items   (FILE *pfd, ui_grp_t *cnt);
+static   size_t      _ui_grp_size      (ui_grp_t *ui_grp);
+static   void        _ui_grp_layout    (ui_grp_t *ui_grp);
+static   __u32       _ui_hash          (__u32 hash, const void *data, size_t len);
+static   __u32       _ui_cfg_hash      (FILE *pfd, __u32 *cfg_size);
+static   ui_grp_t    *_ui_cache_load   (fb_info_t *fb, const char *cfg_filename,
+                                          __u32 hash, __u32 cfg_size);
+static   void        _ui_cache_save    (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          const char *cfg_filename,
+                                          __u32 hash, __u32 cfg_size);
 
 static   int         _my_strlen        (char *str);
-static   int         _ui_str_scale     (int w, int h, int lw, int slen);
+static   int         _ui_str_scale     (r_item_t *r_item, int slen);
 static   void        _ui_str_pos_xy    (r_item_t *r_item, s_item_t *s_item);
-static   void        _ui_clr_str       (fb_info_t *fb, r_item_t *r_item, s_item_t *s_item);
+static   void        _ui_str_rect      (s_item_t *s_item, fb_rect_t *rect);
+static   void        _ui_push_clip     (fb_info_t *fb, r_item_t *r_item);
 static   void        _ui_update_r      (fb_info_t *fb, r_item_t *r_item);
-static   void        _ui_update_s      (fb_info_t *fb, s_item_t *s_item, int x, int y);
+static   void        _ui_update_s      (fb_info_t *fb, s_item_t *s_item, r_item_t *r_item);
+static   void        _ui_str_drawn     (s_item_t *s_item);
+static   void        _ui_draw_run      (fb_info_t *fb, s_item_t *s_item, int x, int y,
+                                          int col, const char *s, const char *e);
+static   void        _ui_diff_s        (fb_info_t *fb, s_item_t *s_item, r_item_t *r_item);
+static   void        _ui_redraw_s      (fb_info_t *fb, s_item_t *s_item, r_item_t *r_item);
 static   void        _ui_update_extra  (fb_info_t *fb, ui_grp_t *ui_grp, int id);
+static   w_item_t    *_ui_find_w_item  (ui_grp_t *ui_grp, int id);
+static   void        _ui_w_dirty       (ui_grp_t *ui_grp, int id);
+static   char        *_ui_w_line       (ui_grp_t *ui_grp, w_item_t *w_item, int back);
+static   int         *_ui_w_samples    (ui_grp_t *ui_grp, w_item_t *w_item);
+static   int         _ui_w_sample      (ui_grp_t *ui_grp, w_item_t *w_item, int back);
+static   int         _ui_w_bin         (w_item_t *w_item, int value);
+static   void        _ui_w_hist_count  (ui_grp_t *ui_grp, w_item_t *w_item);
+static   int         _ui_w_range       (int value);
+static   void        _ui_w_bar         (fb_info_t *fb, w_item_t *w_item,
+                                          int x, int y, int w, int h, int value, int v_max);
+static   void        _ui_update_log    (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                          int x, int y, int w, int h);
+static   void        _ui_update_spark  (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                          int x, int y, int w, int h);
+static   void        _ui_update_hist   (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                          int x, int y, int w, int h);
+static   void        _ui_update_grid   (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                          int x, int y, int w, int h);
+static   void        _ui_update_w      (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item);
 static   void        _ui_update        (fb_info_t *fb, ui_grp_t *ui_grp, int id);
-static   void        _ui_parser_cmd_C  (char *buf, fb_info_t *fb, ui_grp_t *ui_grp);
+static   void        _ui_resolve       (ui_grp_t *ui_grp);
+static   r_item_t    *_ui_match_r_item (ui_grp_t *ui_grp, r_item_t *r_item, ui_grp_t *other);
+static   s_item_t    *_ui_match_s_item (ui_grp_t *ui_grp, s_item_t *s_item, ui_grp_t *other);
+static   bool        _ui_box_same      (ui_grp_t *ui_grp, int id, ui_grp_t *other);
+static   bool        _ui_rect_overlap  (int x, int y, int w, int h, int x2, int y2, int w2, int h2);
+static   void        _ui_swap_touch    (ui_grp_t *ui_grp, int x, int y, int w, int h);
+static   void        _ui_swap_box_dirty(ui_grp_t *ui_grp, int id);
+static   void        _ui_swap_dirty    (ui_grp_t *old, ui_grp_t *ui_grp);
+static   void        _ui_swap_widget   (ui_grp_t *old, ui_grp_t *ui_grp);
+static   int         _ui_widget_type   (char *ptr);
+static   int         _ui_widget_size   (int type, int rows, int bins);
+static   bool        _ui_cache_check   (ui_grp_t *ui_grp);
+static   void        _ui_bind_set      (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind,
+                                          const void *v, size_t size);
+static   void        _ui_parser_cmd_C  (char *buf, ui_grp_t *ui_grp);
 static   void        _ui_parser_cmd_R  (char *buf, fb_info_t *fb, ui_grp_t *ui_grp);
 static   void        _ui_parser_cmd_S  (char *buf, fb_info_t *fb, ui_grp_t *ui_grp);
 static   void        _ui_parser_cmd_G  (char *buf, fb_info_t *fb, ui_grp_t *ui_grp);
+static   void        _ui_parser_cmd_W  (char *buf, ui_grp_t *ui_grp);
 
          void        ui_set_ritem      (fb_info_t *fb, ui_grp_t *ui_grp,
                                           int f_id, int bc, int lc);
@@ -56,8 +143,28 @@ static   void        _ui_parser_cmd_G  (char *buf, fb_info_t *fb, ui_grp_t *ui_g
                                  int id, int x, int y, int scale, int font, char *fmt, ...);
          void        ui_set_printf     (fb_info_t *fb, ui_grp_t *ui_grp,
                                  int id, char *fmt, ...);
+         void        ui_bind           (ui_bind_t *bind, int id, ui_bind_e type,
+                                          int scale, const char *fmt);
+         void        ui_bind_int       (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          ui_bind_t *bind, int v);
+         void        ui_bind_mac       (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          ui_bind_t *bind, const __u8 *mac);
+         void        ui_bind_ip        (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          ui_bind_t *bind, const __u8 *ip);
+         void        ui_bind_pass      (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          ui_bind_t *bind, bool pass);
+         void        ui_bind_usec      (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          ui_bind_t *bind, __u32 usec);
+         void        ui_log            (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          int id, char *fmt, ...);
+         void        ui_sample         (fb_info_t *fb, ui_grp_t *ui_grp, int id, int value);
+         void        ui_cell           (fb_info_t *fb, ui_grp_t *ui_grp,
+                                          int id, int cell, int color);
          void        ui_update         (fb_info_t *fb, ui_grp_t *ui_grp, int id);
+         void        ui_flush          (fb_info_t *fb, ui_grp_t *ui_grp);
+         void        ui_swap           (fb_info_t *fb, ui_grp_t *old, ui_grp_t *ui_grp);
          void        ui_close          (ui_grp_t *ui_grp);
+         ui_grp_t    *ui_load          (fb_info_t *fb, const char *cfg_filename);
          ui_grp_t    *ui_init          (fb_info_t *fb, const char *cfg_filename);
 
 //------------------------------------------------------------------------------
@@ -73,6 +180,7 @@ static   void        _ui_parser_cmd_G  (char *buf, fb_info_t *fb, ui_grp_t *ui_g
    'C' : default config data
    'L' : Line data
    'G' : Rect group data
+   'W' : widget data (박스 안에 표시되는 log 등)
 
    Rect data x, y, w, h는 fb의 비율값 (0%~100%), 모든 컬러값은 32bits rgb data.
 
@@ -83,76 +191,198 @@ static   void        _ui_parser_cmd_G  (char *buf, fb_info_t *fb, ui_grp_t *ui_g
 //------------------------------------------------------------------------------
 static r_item_t *_ui_find_r_item (ui_grp_t *ui_grp, int *sid, int fid)
 {
-   int i;
+   int pos;
    /*
       여러개의 같은 아이디가 있을 수 있으므로 아래와 같이 검색한다.
-      *sid = 시작 아이디
+      *sid = fid 색인 목록에서의 시작 위치 (처음 검색시 0)
       fid  = 찾을 아이디
    */
-   for (i = *sid; i < ui_grp->r_cnt; i++) {
-      if (fid == ui_grp->r_item[i].id) {
-         *sid = i + 1;
-         return &ui_grp->r_item[i];
-      }
-   }
-   return NULL;
+   if ((fid < 0) || (fid >= ui_grp->id_cnt))
+      return NULL;
+
+   pos = ui_grp->r_off[fid] + *sid;
+   if (pos >= ui_grp->r_off[fid + 1])
+      return NULL;
+
+   *sid = *sid + 1;
+   return &ui_grp->r_item[ui_grp->r_idx[pos]];
 }
 
 //------------------------------------------------------------------------------
 static s_item_t *_ui_find_s_item (ui_grp_t *ui_grp, int *sid, int fid)
 {
-   int i;
+   int pos;
    /*
       여러개의 같은 아이디가 있을 수 있으므로 아래와 같이 검색한다.
-      *sid = 시작 아이디
+      *sid = fid 색인 목록에서의 시작 위치 (처음 검색시 0)
       fid  = 찾을 아이디
    */
-   for (i = *sid; i < ui_grp->s_cnt; i++) {
-      if (fid == ui_grp->s_item[i].r_id) {
-         *sid = i + 1;
-         return &ui_grp->s_item[i];
-      }
-   }
-   return NULL;
+   if ((fid < 0) || (fid >= ui_grp->id_cnt))
+      return NULL;
+
+   pos = ui_grp->s_off[fid] + *sid;
+   if (pos >= ui_grp->s_off[fid + 1])
+      return NULL;
+
+   *sid = *sid + 1;
+   return &ui_grp->s_item[ui_grp->s_idx[pos]];
 }
 
 //------------------------------------------------------------------------------
-static int _my_strlen(char *str)
+/*
+   id -> item 목록 색인을 만든다. (counting sort)
+   off[id] 는 id의 첫 item이 idx 배열에서 시작하는 위치이며
+   같은 id의 item은 config 파일에 선언된 순서를 유지한다.
+   (색인 배열은 ui_init에서 item과 함께 할당되어 있음)
+*/
+static void _ui_build_index (ui_grp_t *ui_grp)
 {
-   int cnt = 0, err = 512;
+   int i, id, id_cnt = ui_grp->id_cnt;
 
-   /* utf-8 에서 한글표현은 3바이트 */
-   while ((*str != 0x00) && err--) {
-      if (*str & 0x80) {
-         str += 3;   cnt += 2;
-      } else {
-         str += 1;   cnt++;
-      }
+   /* id 별 item 개수 */
+   for (i = 0; i < ui_grp->r_cnt; i++)
+      if (((id = ui_grp->r_item[i].id) >= 0) && (id < id_cnt))
+         ui_grp->r_off[id + 1]++;
+   for (i = 0; i < ui_grp->s_cnt; i++)
+      if (((id = ui_grp->s_item[i].r_id) >= 0) && (id < id_cnt))
+         ui_grp->s_off[id + 1]++;
+
+   /* 누적합 -> 시작 위치 */
+   for (id = 0; id < id_cnt; id++) {
+      ui_grp->r_off[id + 1] += ui_grp->r_off[id];
+      ui_grp->s_off[id + 1] += ui_grp->s_off[id];
+   }
+
+   /* r_off[id] 를 채움 위치로 사용한 후 한칸씩 밀어서 원래 값으로 되돌린다. */
+   for (i = 0; i < ui_grp->r_cnt; i++)
+      if (((id = ui_grp->r_item[i].id) >= 0) && (id < id_cnt))
+         ui_grp->r_idx[ui_grp->r_off[id]++] = i;
+   for (i = 0; i < ui_grp->s_cnt; i++)
+      if (((id = ui_grp->s_item[i].r_id) >= 0) && (id < id_cnt))
+         ui_grp->s_idx[ui_grp->s_off[id]++] = i;
+
+   for (id = id_cnt; id > 0; id--) {
+      ui_grp->r_off[id] = ui_grp->r_off[id - 1];
+      ui_grp->s_off[id] = ui_grp->s_off[id - 1];
    }
-   return err ? cnt : 0;
+   ui_grp->r_off[0] = ui_grp->s_off[0] = 0;
 }
 
 //------------------------------------------------------------------------------
-static int _ui_str_scale (int w, int h, int lw, int slen)
+static bool _ui_is_extra (ui_grp_t *ui_grp, int id)
 {
-   int as, w_len, h_len;
+   /* 박스(r_item)가 없는 id의 문자열은 화면 절대 좌표에 표시하는 extra item */
+   if ((id < 0) || (id >= ui_grp->id_cnt))
+      return true;
+   return (ui_grp->r_off[id] == ui_grp->r_off[id + 1]);
+}
 
-   /* auto scaling */
-   /* 배율이 설정되어진 최대치 보다 큰 경우 종료한다. */
-   for (as = 1; as < ITEM_SCALE_MAX; as++) {
-      w_len = FONT_ASCII_WIDTH * as * slen + lw * 2;
-      h_len = FONT_HEIGHT      * as        + lw * 2;
-      /*
-         만약 배율이 1인 경우에도 화면에 표시되지 않는 경우 scale은 0값이 되고
-         문자열은 화면상의 표시가 되지 않는다.
-      */
-      if ((w_len > w) || (h_len > h)) {
-         if (as == 1)
-            err("String length too big. String can't display(scale = 0).\n");
-         return (as -1);
+//------------------------------------------------------------------------------
+/*
+   config 파일을 처음부터 읽어 item 저장 공간의 크기를 구한다.
+   r_max, s_max, w_max = 박스/문자열/widget item 개수,
+   w_bytes = widget ring buffer 크기, id_cnt = 가장 큰 id + 1
+*/
+static bool _ui_count_items (FILE *pfd, ui_grp_t *cnt)
+{
+   char buf[256], *ptr, cmd, is_cfg_file = 0;
+   int id, r_cnt, g_cnt, type, rows, size;
+
+   cnt->r_max = cnt->s_max = cnt->w_max = cnt->w_bytes = cnt->id_cnt = 0;
+   memset (buf, 0x00, sizeof(buf));
+
+   while(fgets(buf, sizeof(buf), pfd) != NULL) {
+      if (!is_cfg_file) {
+         is_cfg_file = strncmp ("ODROID-UI-CONFIG", buf, strlen(buf)-1) == 0 ? 1 : 0;
+         memset (buf, 0x00, sizeof(buf));
+         continue;
+      }
+      cmd = buf[0];  id = -1;
+      if ((cmd == 'R') || (cmd == 'S') || (cmd == 'G') || (cmd == 'W')) {
+         ptr = strtok (buf, ",");
+         if ((ptr = strtok (NULL, ",")) != NULL)
+            id = atoi(ptr);
+      }
+      switch(cmd) {
+         case  'R':  cnt->r_max += 1;   break;
+         case  'S':  cnt->s_max += 1;   break;
+         case  'G':
+            /* G, s_id, r_cnt, s_h, r_h, g_cnt ... */
+            r_cnt = ((ptr = strtok (NULL, ",")) != NULL) ? atoi(ptr) : 0;
+            strtok (NULL, ",");  strtok (NULL, ",");
+            g_cnt = ((ptr = strtok (NULL, ",")) != NULL) ? atoi(ptr) : 0;
+            if ((r_cnt > 0) && (g_cnt > 0)) {
+               cnt->r_max += r_cnt * g_cnt;
+               id         += r_cnt * g_cnt - 1;
+            }
+         break;
+         case  'W':
+            /* W, id, type, rows, scale, fc, bc, fn(bins) */
+            type = ((ptr = strtok (NULL, ",")) != NULL) ? _ui_widget_type(ptr) : -1;
+            rows = ((ptr = strtok (NULL, ",")) != NULL) ? atoi(ptr) : 0;
+            strtok (NULL, ",");  strtok (NULL, ",");  strtok (NULL, ",");
+            size = ((ptr = strtok (NULL, ",")) != NULL) ?
+                     _ui_widget_size (type, rows, atoi(ptr)) : 0;
+            if (size > 0) {
+               cnt->w_max   += 1;
+               cnt->w_bytes += size;
+            }
+         break;
+         default :
+         break;
       }
+      if (id >= cnt->id_cnt)
+         cnt->id_cnt = id + 1;
+      memset (buf, 0x00, sizeof(buf));
    }
-   return ITEM_SCALE_MAX;
+   return is_cfg_file ? true : false;
+}
+
+//------------------------------------------------------------------------------
+static int _my_strlen(char *str)
+{
+   const char *p = str;
+   int cnt = 0;
+
+   /* 화면상의 폭 (ASCII 1칸, 그 외 문자는 한글 폭인 2칸으로 그려진다) */
+   while (*p != 0x00)
+      cnt += (fb_utf8_decode(&p) < 0x80) ? 1 : 2;
+
+   return cnt;
+}
+
+//------------------------------------------------------------------------------
+static int _ui_str_scale (r_item_t *r_item, int slen)
+{
+   int as, w, h;
+
+   /* 같은 박스에 같은 길이의 문자열이면 이전 결과를 사용한다. */
+   if (r_item->as_len == slen + 1)
+      return r_item->as_scale;
+
+   /*
+      auto scaling
+      박스의 line 안쪽에 들어가는 최대 배율을 바로 구한다.
+         FONT_HEIGHT * as <= h,  FONT_ASCII_WIDTH * as * slen <= w
+   */
+   w  = r_item->w - r_item->lw * 2;
+   h  = r_item->h - r_item->lw * 2;
+   as = (h > 0) ? (h / FONT_HEIGHT) : 0;
+   if (slen && (as > 0))
+      as = (w < FONT_ASCII_WIDTH * as * slen) ?
+            ((w > 0) ? w / (FONT_ASCII_WIDTH * slen) : 0) : as;
+   if (as > ITEM_SCALE_MAX)
+      as = ITEM_SCALE_MAX;
+
+   /*
+      만약 배율이 1인 경우에도 화면에 표시되지 않는 경우 scale은 0값이 되고
+      문자열은 화면상의 표시가 되지 않는다.
+   */
+   if (as == 0)
+      err("String length too big. String can't display(scale = 0).\n");
+
+   r_item->as_len = slen + 1;   r_item->as_scale = as;
+   return as;
 }
 
 //------------------------------------------------------------------------------
@@ -169,105 +399,909 @@ static void _ui_str_pos_xy (r_item_t *r_item, s_item_t *s_item)
 }
 
 //------------------------------------------------------------------------------
-static void _ui_clr_str (fb_info_t *fb, r_item_t *r_item, s_item_t *s_item)
+static void _ui_str_rect (s_item_t *s_item, fb_rect_t *rect)
+{
+   /* 문자열이 그려지는 영역 (r_item 기준 좌표, extra item은 화면 좌표) */
+   rect->x = s_item->x;
+   rect->y = s_item->y;
+   rect->w = _my_strlen(s_item->str) * FONT_ASCII_WIDTH * s_item->scale;
+   rect->h = FONT_HEIGHT * s_item->scale;
+}
+
+//------------------------------------------------------------------------------
+static void _ui_push_clip (fb_info_t *fb, r_item_t *r_item)
+{
+   /* 박스 외곽선 안쪽 영역 */
+   fb_push_clip (fb, r_item->x + r_item->lw, r_item->y + r_item->lw,
+                     r_item->w - r_item->lw * 2, r_item->h - r_item->lw * 2);
+}
+
+//------------------------------------------------------------------------------
+static size_t _ui_grp_size (ui_grp_t *ui_grp)
+{
+   /*
+      [ui_grp_t][r_item x r_max][s_item x s_max][w_item x w_max]
+      [r_off][s_off][r_idx][s_idx][w_data]
+   */
+   return   sizeof(ui_grp_t)
+         +  sizeof(r_item_t) * ui_grp->r_max + sizeof(s_item_t) * ui_grp->s_max
+         +  sizeof(w_item_t) * ui_grp->w_max
+         +  sizeof(int) * ((ui_grp->id_cnt + 1) * 2 + ui_grp->r_max + ui_grp->s_max)
+         +  ui_grp->w_bytes;
+}
+
+//------------------------------------------------------------------------------
+static void _ui_grp_layout (ui_grp_t *ui_grp)
+{
+   /* ui_grp 뒤에 할당된 item/색인 배열의 위치를 설정한다. */
+   ui_grp->r_item = (r_item_t *)(ui_grp + 1);
+   ui_grp->s_item = (s_item_t *)(ui_grp->r_item + ui_grp->r_max);
+   ui_grp->w_item = (w_item_t *)(ui_grp->s_item + ui_grp->s_max);
+   ui_grp->r_off  = (int *)(ui_grp->w_item + ui_grp->w_max);
+   ui_grp->s_off  = ui_grp->r_off + ui_grp->id_cnt + 1;
+   ui_grp->r_idx  = ui_grp->s_off + ui_grp->id_cnt + 1;
+   ui_grp->s_idx  = ui_grp->r_idx + ui_grp->r_max;
+   ui_grp->w_data = (char *)(ui_grp->s_idx + ui_grp->s_max);
+}
+
+//------------------------------------------------------------------------------
+static __u32 _ui_hash (__u32 hash, const void *data, size_t len)
+{
+   /* FNV-1a 32bits (처음 호출시 hash = 2166136261) */
+   const unsigned char *p = (const unsigned char *)data;
+
+   while (len--)
+      hash = (hash ^ *p++) * 16777619u;
+   return hash;
+}
+
+//------------------------------------------------------------------------------
+static __u32 _ui_cfg_hash (FILE *pfd, __u32 *cfg_size)
+{
+   __u32 hash = 2166136261u;
+   unsigned char buf[1024];
+   size_t len;
+
+   *cfg_size = 0;
+   while ((len = fread (buf, 1, sizeof(buf), pfd)) > 0) {
+      hash = _ui_hash (hash, buf, len);
+      *cfg_size += len;
+   }
+   return hash;
+}
+
+//------------------------------------------------------------------------------
+static ui_grp_t *_ui_cache_load (fb_info_t *fb, const char *cfg_filename,
+                                 __u32 hash, __u32 cfg_size)
+{
+   char path[PATH_MAX];
+   struct stat st;
+   ui_cache_t *cache;
+   ui_grp_t *ui_grp;
+   void *map;
+   int fd;
+
+   snprintf (path, sizeof(path), "%s%s", cfg_filename, UI_CACHE_EXT);
+   if ((fd = open (path, O_RDONLY)) < 0)
+      return NULL;
+
+   if ((fstat (fd, &st) < 0) || (st.st_size < (off_t)sizeof(ui_cache_t))) {
+      close (fd);
+      return NULL;
+   }
+   /* MAP_PRIVATE : 화면 갱신 중 바뀌는 item 내용은 파일에 반영되지 않음 */
+   map = mmap (NULL, st.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+   close (fd);
+   if (map == MAP_FAILED)
+      return NULL;
+
+   cache  = (ui_cache_t *)map;
+   ui_grp = (ui_grp_t *)(cache + 1);
+
+   if (memcmp (cache->magic, UI_CACHE_MAGIC, sizeof(cache->magic))  ||
+       (cache->version  != UI_CACHE_VERSION) ||
+       (cache->hash     != hash)             || (cache->cfg_size != cfg_size) ||
+       (cache->w        != fb->w)            || (cache->h        != fb->h)    ||
+       (cache->grp_size != sizeof(ui_grp_t)) ||
+       (cache->r_size   != sizeof(r_item_t)) ||
+       (cache->s_size   != sizeof(s_item_t)) ||
+       (cache->w_size   != sizeof(w_item_t)) ||
+       (st.st_size != (off_t)(sizeof(ui_cache_t) + cache->size))        ||
+       (ui_grp->r_max < 0) || (ui_grp->s_max < 0) || (ui_grp->w_max < 0) ||
+       (ui_grp->id_cnt < 0) || (ui_grp->w_bytes < 0) ||
+       (ui_grp->r_cnt < 0) || (ui_grp->r_cnt > ui_grp->r_max) ||
+       (ui_grp->s_cnt < 0) || (ui_grp->s_cnt > ui_grp->s_max) ||
+       (ui_grp->w_cnt < 0) || (ui_grp->w_cnt > ui_grp->w_max) ||
+       ((size_t)cache->size != _ui_grp_size (ui_grp))) {
+      munmap (map, st.st_size);
+      return NULL;
+   }
+
+   _ui_grp_layout (ui_grp);
+   if (!_ui_cache_check (ui_grp)) {
+      dbg ("layout cache broken, ignore. (%s)\n", path);
+      munmap (map, st.st_size);
+      return NULL;
+   }
+   ui_grp->map      = map;
+   ui_grp->map_size = st.st_size;
+   return ui_grp;
+}
+
+//------------------------------------------------------------------------------
+/*
+   cache 파일에서 읽은 내용을 그대로 믿지 않는다.
+   id 색인은 item에서 다시 만들고, widget data 위치와 문자열 끝을 확인한다.
+*/
+static bool _ui_cache_check (ui_grp_t *ui_grp)
+{
+   int i;
+   w_item_t *w_item;
+
+   memset (ui_grp->r_off, 0x00, sizeof(int) * (ui_grp->id_cnt + 1));
+   memset (ui_grp->s_off, 0x00, sizeof(int) * (ui_grp->id_cnt + 1));
+   _ui_build_index (ui_grp);
+
+   for (i = 0; i < ui_grp->w_cnt; i++) {
+      w_item = &ui_grp->w_item[i];
+      if ((w_item->size != _ui_widget_size (w_item->type, w_item->rows, w_item->bins)) ||
+          (w_item->size <= 0) || (w_item->data < 0) ||
+          (w_item->data > ui_grp->w_bytes - w_item->size) ||
+          ((w_item->type == eWIDGET_GRID) && (w_item->bins <= 0)) ||
+          (w_item->head < 0) || (w_item->head >= w_item->rows) ||
+          (w_item->cnt  < 0) || (w_item->cnt  >  w_item->rows) ||
+          (w_item->shown < 0) || (w_item->shown > w_item->rows) ||
+          (w_item->pending < 0) || (w_item->pending > w_item->rows))
+         return false;
+   }
+   for (i = 0; i < ui_grp->s_cnt; i++) {
+      ui_grp->s_item[i].str  [ITEM_STR_MAX -1] = 0x00;
+      ui_grp->s_item[i].d_str[ITEM_STR_MAX -1] = 0x00;
+   }
+   return true;
+}
+
+//------------------------------------------------------------------------------
+static void _ui_cache_save (fb_info_t *fb, ui_grp_t *ui_grp,
+                              const char *cfg_filename,
+                              __u32 hash, __u32 cfg_size)
+{
+   char path[PATH_MAX], tmp[PATH_MAX + 16];
+   ui_cache_t cache;
+   size_t size = _ui_grp_size (ui_grp);
+   int fd;
+   bool ok;
+
+   memset (&cache, 0x00, sizeof(cache));
+   memcpy (cache.magic, UI_CACHE_MAGIC, sizeof(cache.magic));
+   cache.version  = UI_CACHE_VERSION;
+   cache.hash     = hash;              cache.cfg_size = cfg_size;
+   cache.w        = fb->w;             cache.h        = fb->h;
+   cache.grp_size = sizeof(ui_grp_t);
+   cache.r_size   = sizeof(r_item_t);  cache.s_size   = sizeof(s_item_t);
+   cache.w_size   = sizeof(w_item_t);
+   cache.size     = size;
+
+   /* 다른 process가 쓰다 만 파일을 읽지 않도록 임시 파일에 쓴 후 rename */
+   snprintf (path, sizeof(path), "%s%s", cfg_filename, UI_CACHE_EXT);
+   snprintf (tmp,  sizeof(tmp),  "%s.%d", path, getpid());
+   if ((fd = open (tmp, O_WRONLY | O_CREAT | O_TRUNC, 0644)) < 0) {
+      dbg ("layout cache save skip. (%s : %s)\n", tmp, strerror(errno));
+      return;
+   }
+   ok = (write (fd, &cache, sizeof(cache)) == sizeof(cache)) &&
+        (write (fd, ui_grp, size) == (ssize_t)size);
+   close (fd);
+
+   if (!ok || (rename (tmp, path) < 0)) {
+      err ("layout cache save fail! (%s)\n", path);
+      unlink (tmp);
+   }
+}
+
+//------------------------------------------------------------------------------
+static void _ui_update_r (fb_info_t *fb, r_item_t *r_item)
+{
+   draw_fill_rect (fb, r_item->x, r_item->y, r_item->w, r_item->h,
+                     r_item->bc.uint);
+   if (r_item->lw)
+      draw_rect (fb, r_item->x, r_item->y, r_item->w, r_item->h, r_item->lw,
+                     r_item->lc.uint);
+}
+
+//------------------------------------------------------------------------------
+/*
+   r_item 에 속한 문자열은 박스 외곽선 안쪽 영역으로 clip 하여 그린다.
+   (r_item == NULL 이면 extra item, 화면 절대 좌표)
+*/
+static void _ui_update_s (fb_info_t *fb, s_item_t *s_item, r_item_t *r_item)
+{
+   set_font (s_item->f_type);
+   _ui_str_rect (s_item, &s_item->drawn);
+   _ui_str_drawn (s_item);
+
+   if (r_item == NULL) {
+      draw_text (fb, s_item->x, s_item->y, s_item->fc.uint, s_item->bc.uint,
+                  s_item->scale, "%s", s_item->str);
+      return;
+   }
+   _ui_push_clip (fb, r_item);
+   draw_text (fb, r_item->x + s_item->x, r_item->y + s_item->y,
+               s_item->fc.uint, s_item->bc.uint, s_item->scale, "%s", s_item->str);
+   fb_pop_clip (fb);
+}
+
+//------------------------------------------------------------------------------
+static void _ui_str_drawn (s_item_t *s_item)
+{
+   memcpy (s_item->d_str, s_item->str, ITEM_STR_MAX);
+   s_item->d_scale = s_item->scale;    s_item->d_font = s_item->f_type;
+   s_item->d_fc    = s_item->fc;       s_item->d_bc   = s_item->bc;
+}
+
+//------------------------------------------------------------------------------
+/*
+   문자열 중 str[s] ~ str[e -1] 부분을 col 번째 글자 칸 위치에 그린다.
+   (x, y = 문자열 시작 위치의 화면 좌표)
+*/
+static void _ui_draw_run (fb_info_t *fb, s_item_t *s_item, int x, int y,
+                           int col, const char *s, const char *e)
+{
+   char buf[ITEM_STR_MAX];
+
+   memcpy (buf, s, e - s);    buf[e - s] = 0x00;
+   draw_text (fb, x + col * FONT_ASCII_WIDTH * s_item->scale, y,
+               s_item->fc.uint, s_item->bc.uint, s_item->scale, "%s", buf);
+}
+
+//------------------------------------------------------------------------------
+/*
+   위치, 배율, 폰트, 색상이 이전에 그린 것과 같은 경우 이전 문자열(d_str)과
+   글자 칸 단위로 비교하여 다른 글자만 다시 그린다. (연속된 글자는 한번에)
+   glyph는 배경색까지 칸 전체를 덮어 그리므로 같은 칸의 이전 글자는 지울 필요가 없고,
+   새 문자열보다 길었던 부분만 배경색으로 지운다.
+*/
+static void _ui_diff_s (fb_info_t *fb, s_item_t *s_item, r_item_t *r_item)
+{
+   const char *p = s_item->str, *q = s_item->d_str, *s, *t, *run = NULL;
+   int x, y, col = 0, q_col = 0, run_col = 0;
+   unsigned int code;
+   fb_rect_t n, *o = &s_item->drawn;
+
+   _ui_str_rect (s_item, &n);
+   x = (r_item != NULL) ? r_item->x + s_item->x : s_item->x;
+   y = (r_item != NULL) ? r_item->y + s_item->y : s_item->y;
+
+   set_font (s_item->f_type);
+   if (r_item != NULL)
+      _ui_push_clip (fb, r_item);
+
+   while (*p) {
+      s    = p;
+      code = fb_utf8_decode (&p);
+
+      /* 같은 글자 칸 위치에서 시작하는 이전 글자를 찾는다. */
+      while (*q && (q_col < col))
+         q_col += (fb_utf8_decode (&q) < 0x80) ? 1 : 2;
+      t = q;
+      if (*q && (q_col == col) && (fb_utf8_decode (&t) == code)) {
+         if (run != NULL)
+            _ui_draw_run (fb, s_item, x, y, run_col, run, s);
+         run = NULL;
+      }
+      else if (run == NULL) {
+         run = s;    run_col = col;
+      }
+      col += (code < 0x80) ? 1 : 2;
+   }
+   if (run != NULL)
+      _ui_draw_run (fb, s_item, x, y, run_col, run, p);
+
+   if (o->w > n.w)
+      draw_fill_rect (fb, x + n.w, y, o->w - n.w, o->h, s_item->bc.uint);
+
+   if (r_item != NULL)
+      fb_pop_clip (fb);
+
+   *o = n;
+   _ui_str_drawn (s_item);
+}
+
+//------------------------------------------------------------------------------
+/*
+   이전에 그려진 문자열 영역이 새 문자열 영역 밖으로 남는 경우
+   남는 영역을 배경색으로 지운 후 새 문자열을 그린다.
+*/
+static void _ui_redraw_s (fb_info_t *fb, s_item_t *s_item, r_item_t *r_item)
+{
+   fb_rect_t n, *o = &s_item->drawn;
+
+   _ui_str_rect (s_item, &n);
+
+   /* 문자열만 바뀐 경우 (가운데 정렬로 위치가 바뀌면 전체를 다시 그린다) */
+   if ((o->h > 0) && (o->x == n.x) && (o->y == n.y) &&
+       (s_item->d_scale == s_item->scale) && (s_item->d_font == s_item->f_type) &&
+       (s_item->d_fc.uint == s_item->fc.uint) &&
+       (s_item->d_bc.uint == s_item->bc.uint)) {
+      _ui_diff_s (fb, s_item, r_item);
+      return;
+   }
+
+   if ((o->w > 0) && (o->h > 0) &&
+       ((o->x < n.x) || (o->y < n.y) ||
+        (o->x + o->w > n.x + n.w) || (o->y + o->h > n.y + n.h))) {
+      if (r_item != NULL) {
+         _ui_push_clip (fb, r_item);
+         draw_fill_rect (fb, r_item->x + o->x, r_item->y + o->y, o->w, o->h,
+                           s_item->bc.uint);
+         fb_pop_clip (fb);
+      }
+      else
+         draw_fill_rect (fb, o->x, o->y, o->w, o->h, s_item->bc.uint);
+   }
+   _ui_update_s (fb, s_item, r_item);
+}
+
+//------------------------------------------------------------------------------
+static void _ui_update_extra (fb_info_t *fb, ui_grp_t *ui_grp, int id)
+{
+   // extra item update
+   int n_sid = 0;
+   s_item_t *s_item;
+
+   while ((s_item = _ui_find_s_item(ui_grp, &n_sid, id)) != NULL) {
+      _ui_update_s (fb, s_item, NULL);
+      s_item->dirty = false;
+   }
+}
+
+//------------------------------------------------------------------------------
+static w_item_t *_ui_find_w_item (ui_grp_t *ui_grp, int id)
+{
+   int i;
+
+   /* widget은 개수가 적으므로 순서대로 찾는다. */
+   for (i = 0; i < ui_grp->w_cnt; i++)
+      if (ui_grp->w_item[i].id == id)
+         return &ui_grp->w_item[i];
+   return NULL;
+}
+
+//------------------------------------------------------------------------------
+static void _ui_w_dirty (ui_grp_t *ui_grp, int id)
+{
+   int i;
+
+   /* 박스가 다시 그려지면 박스 안의 widget은 전체를 다시 그린다. */
+   for (i = 0; i < ui_grp->w_cnt; i++)
+      if (ui_grp->w_item[i].id == id)
+         ui_grp->w_item[i].dirty = true;
+}
+
+//------------------------------------------------------------------------------
+/* ring buffer의 최근 back 번째 line (back = 0 이면 마지막에 추가된 line) */
+static char *_ui_w_line (ui_grp_t *ui_grp, w_item_t *w_item, int back)
+{
+   int pos = (w_item->head - 1 - back + w_item->rows) % w_item->rows;
+
+   return ui_grp->w_data + w_item->data + pos * ITEM_STR_MAX;
+}
+
+//------------------------------------------------------------------------------
+/* SPARK/HIST의 sample ring buffer, HIST는 뒤에 막대별 sample 수가 이어짐 */
+static int *_ui_w_samples (ui_grp_t *ui_grp, w_item_t *w_item)
+{
+   return (int *)(ui_grp->w_data + w_item->data);
+}
+
+//------------------------------------------------------------------------------
+/* 최근 back 번째 sample (저장된 sample이 없으면 0) */
+static int _ui_w_sample (ui_grp_t *ui_grp, w_item_t *w_item, int back)
+{
+   if (back >= w_item->cnt)
+      return 0;
+   return _ui_w_samples (ui_grp, w_item)
+            [(w_item->head - 1 - back + w_item->rows) % w_item->rows];
+}
+
+//------------------------------------------------------------------------------
+static int _ui_w_bin (w_item_t *w_item, int value)
+{
+   int bin;
+
+   if (value <= 0)
+      return 0;
+   bin = (int)((long long)value * w_item->bins / w_item->v_max);
+   return (bin < w_item->bins) ? bin : w_item->bins -1;
+}
+
+//------------------------------------------------------------------------------
+/* HIST : ring buffer의 sample로 막대별 개수를 다시 구한다. (세로축 변경시) */
+static void _ui_w_hist_count (ui_grp_t *ui_grp, w_item_t *w_item)
+{
+   int *bins = _ui_w_samples (ui_grp, w_item) + w_item->rows, i;
+
+   memset (bins, 0x00, sizeof(int) * w_item->bins);
+   for (i = 0; i < w_item->cnt; i++)
+      bins[_ui_w_bin (w_item, _ui_w_sample (ui_grp, w_item, i))]++;
+}
+
+//------------------------------------------------------------------------------
+/* 위에서부터 배경색, 아래쪽 value/v_max 높이 만큼 글자색으로 세로 막대를 그린다. */
+static void _ui_w_bar (fb_info_t *fb, w_item_t *w_item,
+                        int x, int y, int w, int h, int value, int v_max)
+{
+   int bh;
+
+   bh = (value <= 0) ? 0 : (value >= v_max) ? h : (int)((long long)value * h / v_max);
+   if (h - bh)
+      draw_fill_rect (fb, x, y, w, h - bh, w_item->bc.uint);
+   if (bh)
+      draw_fill_rect (fb, x, y + h - bh, w, bh, w_item->fc.uint);
+}
+
+//------------------------------------------------------------------------------
+/*
+   LOG widget
+   새 line은 아래쪽 빈 줄에 그리며, 빈 줄이 없으면 기존 line을 pixel 단위로
+   위로 옮긴 후(fb_move_rect) 새로 보이는 줄만 그린다.
+*/
+static void _ui_update_log (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                              int x, int y, int w, int h)
+{
+   int rh, vis, n, s, i;
+
+   rh = FONT_HEIGHT * w_item->scale;
+   vis = (rh > 0) ? (h / rh) : 0;
+   if (vis > w_item->rows)
+      vis = w_item->rows;
+   n = w_item->pending;
+
+   set_font (w_item->f_type);
+
+   if (!w_item->dirty && (w_item->shown + n > vis)) {
+      if (n < vis) {
+         /* s 줄 만큼 위로 scroll 후 아래쪽 n 줄을 비운다. */
+         s = w_item->shown + n - vis;
+         fb_move_rect (fb, x, y + s * rh, w, (vis - s) * rh, x, y);
+         draw_fill_rect (fb, x, y + (vis - n) * rh, w, n * rh, w_item->bc.uint);
+         w_item->shown = vis - n;
+      }
+      else
+         w_item->dirty = true;
+   }
+   if (w_item->dirty) {
+      draw_fill_rect (fb, x, y, w, h, w_item->bc.uint);
+      w_item->shown = 0;
+      n = (w_item->cnt < vis) ? w_item->cnt : vis;
+   }
+
+   /* 새 line n 개를 오래된 순서로 shown 위치부터 그린다. */
+   for (i = 0; i < n; i++)
+      draw_text (fb, x, y + (w_item->shown + i) * rh,
+                  w_item->fc.uint, w_item->bc.uint, w_item->scale,
+                  "%s", _ui_w_line (ui_grp, w_item, n - 1 - i));
+   w_item->shown += n;
+}
+
+//------------------------------------------------------------------------------
+/*
+   SPARK widget
+   sample 1개가 1개의 막대(폭 = 박스 폭 / rows)이며 마지막 sample이 오른쪽 끝에 표시된다.
+   새 sample이 들어오면 기존 막대를 새 sample 수 만큼 왼쪽으로 옮긴 후(fb_move_rect)
+   오른쪽에 새 막대만 그린다.
+*/
+static void _ui_update_spark (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                 int x, int y, int w, int h)
+{
+   int cw, x0, n = w_item->pending, i;
+
+   cw = (w / w_item->rows > 0) ? (w / w_item->rows) : 1;
+   x0 = x + w - cw * w_item->rows;
+
+   if (!w_item->dirty && (n < w_item->rows))
+      fb_move_rect (fb, x0 + n * cw, y, (w_item->rows - n) * cw, h, x0, y);
+   else {
+      draw_fill_rect (fb, x, y, w, h, w_item->bc.uint);
+      n = w_item->rows;
+   }
+
+   for (i = w_item->rows - n; i < w_item->rows; i++)
+      _ui_w_bar (fb, w_item, x0 + i * cw, y, cw, h,
+                  _ui_w_sample (ui_grp, w_item, w_item->rows - 1 - i), w_item->v_max);
+}
+
+//------------------------------------------------------------------------------
+/*
+   HIST widget
+   sample 값(0 ~ v_max)을 bins 개의 구간으로 나누어 구간별 sample 수를 막대로 표시한다.
+   (막대 높이 = sample 수 / rows) 개수가 바뀐 막대(bin_dirty)만 다시 그린다.
+*/
+static void _ui_update_hist (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                int x, int y, int w, int h)
+{
+   int *bins = _ui_w_samples (ui_grp, w_item) + w_item->rows, bw, i;
+
+   bw = (w / w_item->bins > 0) ? (w / w_item->bins) : 1;
+
+   if (w_item->dirty) {
+      draw_fill_rect (fb, x, y, w, h, w_item->bc.uint);
+      w_item->bin_dirty = ~0ULL;
+   }
+   /* 막대 사이 1 pixel은 배경으로 남긴다. */
+   for (i = 0; i < w_item->bins; i++)
+      if (w_item->bin_dirty & (1ULL << i))
+         _ui_w_bar (fb, w_item, x + i * bw, y, (bw > 2) ? bw - 1 : bw, h,
+                     bins[i], w_item->rows);
+   w_item->bin_dirty = 0;
+}
+
+//------------------------------------------------------------------------------
+/*
+   GRID widget
+   rows 개의 셀을 bins 열로 나누어 왼쪽 위부터 차례로 배치하고 셀마다 설정된 색으로 채운다.
+   셀이 충분히 크면 셀 번호(hex)를 fc 색으로 표시한다.
+   설정 색상과 화면에 그려진 색상이 다른 셀만 다시 그린다.
+*/
+static void _ui_update_grid (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item,
+                                int x, int y, int w, int h)
+{
+   int *color = _ui_w_samples (ui_grp, w_item), *shown = color + w_item->rows;
+   int rows, cw, ch, cx, cy, i;
+
+   rows = (w_item->rows + w_item->bins - 1) / w_item->bins;
+   cw   = (w / w_item->bins > 0) ? (w / w_item->bins) : 1;
+   ch   = (h / rows > 0) ? (h / rows) : 1;
+
+   if (w_item->dirty) {
+      draw_fill_rect (fb, x, y, w, h, w_item->bc.uint);
+      for (i = 0; i < w_item->rows; i++)
+         shown[i] = ~color[i];
+   }
+   /* 셀 사이 1 pixel은 배경으로 남긴다. */
+   if (cw > 2)   cw--;
+   if (ch > 2)   ch--;
+
+   for (i = 0; i < w_item->rows; i++) {
+      if (shown[i] == color[i])
+         continue;
+      cx = x + (i % w_item->bins) * (w / w_item->bins);
+      cy = y + (i / w_item->bins) * (h / rows);
+      draw_fill_rect (fb, cx, cy, cw, ch, color[i]);
+      if ((cw >= FONT_ASCII_WIDTH * 2) && (ch >= FONT_HEIGHT))
+         draw_text (fb, cx + (cw - FONT_ASCII_WIDTH * 2) / 2, cy + (ch - FONT_HEIGHT) / 2,
+                     w_item->fc.uint, color[i], 1, "%02X", i);
+      shown[i] = color[i];
+   }
+}
+
+//------------------------------------------------------------------------------
+/*
+   widget 화면 갱신 (박스 외곽선 안쪽 영역)
+   바뀐 부분만 그리며, 박스가 다시 그려졌거나(dirty) 한번에 바뀐 내용이
+   widget 전체보다 많으면 전체를 다시 그린다.
+*/
+static void _ui_update_w (fb_info_t *fb, ui_grp_t *ui_grp, w_item_t *w_item)
+{
+   int n_rid = 0, x, y, w, h;
+   r_item_t *r_item;
+
+   if ((!w_item->dirty && !w_item->pending && !w_item->bin_dirty) ||
+       ((r_item = _ui_find_r_item(ui_grp, &n_rid, w_item->id)) == NULL)) {
+      w_item->dirty = false;  w_item->pending = 0;   w_item->bin_dirty = 0;
+      return;
+   }
+
+   x  = r_item->x + r_item->lw;     w = r_item->w - r_item->lw * 2;
+   y  = r_item->y + r_item->lw;     h = r_item->h - r_item->lw * 2;
+
+   _ui_push_clip (fb, r_item);
+   switch (w_item->type) {
+      case  eWIDGET_LOG:   _ui_update_log   (fb, ui_grp, w_item, x, y, w, h);  break;
+      case  eWIDGET_SPARK: _ui_update_spark (fb, ui_grp, w_item, x, y, w, h);  break;
+      case  eWIDGET_HIST:  _ui_update_hist  (fb, ui_grp, w_item, x, y, w, h);  break;
+      case  eWIDGET_GRID:  _ui_update_grid  (fb, ui_grp, w_item, x, y, w, h);  break;
+      default :
+      break;
+   }
+   fb_pop_clip (fb);
+   w_item->dirty = false;  w_item->pending = 0;   w_item->bin_dirty = 0;
+}
+
+//------------------------------------------------------------------------------
+static void _ui_update (fb_info_t *fb, ui_grp_t *ui_grp, int id)
+{
+   int n_rid = 0, n_sid = 0, i;
+
+   r_item_t *r_item;
+   s_item_t *s_item;
+
+   if (!_ui_is_extra (ui_grp, id)) {
+      while ((r_item = _ui_find_r_item(ui_grp, &n_rid, id)) != NULL) {
+
+         _ui_update_r (fb, r_item);
+         r_item->dirty = false;
+
+         n_sid = 0;
+         while ((s_item = _ui_find_s_item(ui_grp, &n_sid, id)) != NULL) {
+            _ui_update_s (fb, s_item, r_item);
+            s_item->dirty = false;
+         }
+      }
+      _ui_w_dirty (ui_grp, id);
+      for (i = 0; i < ui_grp->w_cnt; i++)
+         _ui_update_w (fb, ui_grp, &ui_grp->w_item[i]);
+   }
+   else
+      _ui_update_extra (fb, ui_grp, id);
+}
+
+//------------------------------------------------------------------------------
+/*
+   기본값(-1)으로 설정된 문자열 item의 색상, 폰트, 배율, 위치를 정한다.
+   박스에 속한 문자열은 같은 id의 첫번째 박스를 기준으로 한다.
+*/
+static void _ui_resolve (ui_grp_t *ui_grp)
+{
+   int i, n_rid;
+   r_item_t *r_item;
+   s_item_t *s_item;
+   w_item_t *w_item;
+
+   for (i = 0; i < ui_grp->s_cnt; i++) {
+      s_item = &ui_grp->s_item[i];
+
+      if (s_item->f_type < 0)             s_item->f_type = ui_grp->f_type;
+      if ((signed)s_item->fc.uint < 0)    s_item->fc.uint = ui_grp->fc.uint;
+
+      n_rid = 0;
+      if ((r_item = _ui_find_r_item(ui_grp, &n_rid, s_item->r_id)) == NULL) {
+         /* 박스가 없는 문자열(extra item) */
+         if (s_item->x < 0)                  s_item->x = 0;
+         if (s_item->y < 0)                  s_item->y = 0;
+         if (s_item->scale  < 0)             s_item->scale  = 1;
+         if ((signed)s_item->bc.uint < 0)    s_item->bc.uint = ui_grp->bc.uint;
+         continue;
+      }
+      if ((signed)s_item->bc.uint < 0)
+         s_item->bc.uint = r_item->bc.uint;
+
+      if (s_item->scale < 0)
+         s_item->scale = _ui_str_scale (r_item, _my_strlen(s_item->str));
+      _ui_str_pos_xy(r_item, s_item);
+   }
+
+   for (i = 0; i < ui_grp->w_cnt; i++) {
+      w_item = &ui_grp->w_item[i];
+
+      if (w_item->f_type < 0)             w_item->f_type = ui_grp->f_type;
+      if ((signed)w_item->fc.uint < 0)    w_item->fc.uint = ui_grp->fc.uint;
+
+      n_rid = 0;
+      if ((r_item = _ui_find_r_item(ui_grp, &n_rid, w_item->id)) == NULL) {
+         err("Widget box not found! (id = %d)\n", w_item->id);
+         if ((signed)w_item->bc.uint < 0)    w_item->bc.uint = ui_grp->bc.uint;
+         if (w_item->scale < 0)              w_item->scale = 1;
+         continue;
+      }
+      if ((signed)w_item->bc.uint < 0)
+         w_item->bc.uint = r_item->bc.uint;
+
+      /* GRID : 모든 셀을 배경색으로 시작한다. */
+      if (w_item->type == eWIDGET_GRID) {
+         int *color = _ui_w_samples (ui_grp, w_item), k;
+
+         for (k = 0; k < w_item->rows; k++)
+            color[k] = w_item->bc.uint;
+         continue;
+      }
+      /* SPARK/HIST : 최대값이 설정되지 않으면 sample에 맞춰 자동으로 정한다. */
+      if (w_item->type != eWIDGET_LOG) {
+         w_item->v_max = (w_item->max > 0) ? w_item->max : 1;
+         continue;
+      }
+
+      /* scale = -1 이면 rows 줄이 박스 안에 들어가는 최대 배율 */
+      if (w_item->scale < 0) {
+         w_item->scale = (r_item->h - r_item->lw * 2) / (FONT_HEIGHT * w_item->rows);
+         if (w_item->scale < 1)                 w_item->scale = 1;
+         if (w_item->scale > ITEM_SCALE_MAX)    w_item->scale = ITEM_SCALE_MAX;
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+/*
+   hot reload : item 과 같은 id, 같은 순번을 가지는 other의 item을 찾는다.
+*/
+static r_item_t *_ui_match_r_item (ui_grp_t *ui_grp, r_item_t *r_item, ui_grp_t *other)
+{
+   int id = r_item->id, pos, n;
+
+   if ((id < 0) || (id >= ui_grp->id_cnt) || (id >= other->id_cnt))
+      return NULL;
+
+   for (pos = ui_grp->r_off[id]; pos < ui_grp->r_off[id + 1]; pos++)
+      if (&ui_grp->r_item[ui_grp->r_idx[pos]] == r_item)
+         break;
+
+   n = pos - ui_grp->r_off[id];
+   if (other->r_off[id] + n >= other->r_off[id + 1])
+      return NULL;
+   return &other->r_item[other->r_idx[other->r_off[id] + n]];
+}
+
+//------------------------------------------------------------------------------
+static s_item_t *_ui_match_s_item (ui_grp_t *ui_grp, s_item_t *s_item, ui_grp_t *other)
 {
-   int color = s_item->fc.uint;
+   int id = s_item->r_id, pos, n;
+
+   if ((id < 0) || (id >= ui_grp->id_cnt) || (id >= other->id_cnt))
+      return NULL;
 
-   /* 기존 String을 배경색으로 다시 그림(텍스트 지움) */
-   /* string x, y 좌표 연산 */
-   s_item->fc.uint = s_item->bc.uint;
-   _ui_str_pos_xy(r_item, s_item);
-   _ui_update_s (fb, s_item, r_item->x, r_item->y);
-   s_item->fc.uint = color;
-   memset (s_item->str, 0x00, ITEM_STR_MAX);
+   for (pos = ui_grp->s_off[id]; pos < ui_grp->s_off[id + 1]; pos++)
+      if (&ui_grp->s_item[ui_grp->s_idx[pos]] == s_item)
+         break;
+
+   n = pos - ui_grp->s_off[id];
+   if (other->s_off[id] + n >= other->s_off[id + 1])
+      return NULL;
+   return &other->s_item[other->s_idx[other->s_off[id] + n]];
 }
 
 //------------------------------------------------------------------------------
-static void _ui_update_r (fb_info_t *fb, r_item_t *r_item)
+static bool _ui_box_same (ui_grp_t *ui_grp, int id, ui_grp_t *other)
 {
-   draw_fill_rect (fb, r_item->x, r_item->y, r_item->w, r_item->h,
-                     r_item->bc.uint);
-   if (r_item->lw)
-      draw_rect (fb, r_item->x, r_item->y, r_item->w, r_item->h, r_item->lw,
-                     r_item->lc.uint);
+   int n_rid = 0, n_oid = 0;
+   r_item_t *r_item, *o_item;
+
+   /* id에 속한 박스들의 정의가 모두 같은지 확인 */
+   while ((r_item = _ui_find_r_item(ui_grp, &n_rid, id)) != NULL) {
+      if (((o_item = _ui_find_r_item(other, &n_oid, id)) == NULL) ||
+          (o_item->def != r_item->def))
+         return false;
+   }
+   return (_ui_find_r_item(other, &n_oid, id) == NULL);
 }
 
 //------------------------------------------------------------------------------
-static void _ui_update_s (fb_info_t *fb, s_item_t *s_item, int x, int y)
+static bool _ui_rect_overlap (int x, int y, int w, int h, int x2, int y2, int w2, int h2)
 {
-   draw_text (fb, x + s_item->x, y + s_item->y, s_item->fc.uint, s_item->bc.uint,
-               s_item->scale, s_item->str);
+   return   (x < x2 + w2) && (x2 < x + w) && (y < y2 + h2) && (y2 < y + h);
 }
 
 //------------------------------------------------------------------------------
-static void _ui_update_extra (fb_info_t *fb, ui_grp_t *ui_grp, int id)
+static void _ui_swap_touch (ui_grp_t *ui_grp, int x, int y, int w, int h)
 {
-   // extra item update
    int i;
-   for (i = 0; i < ui_grp->r_cnt; i++)
-      if (id == ui_grp->r_item[i].id)
-         _ui_update_r (fb, &ui_grp->r_item[i]);
+   r_item_t *r_item;
+   s_item_t *s_item;
+   fb_rect_t rect;
 
-   for (i = 0; i < ui_grp->s_cnt; i++)
-      if (id == ui_grp->s_item[i].r_id)
-         _ui_update_s (fb, &ui_grp->s_item[i], 0, 0);
+   /* 지워진 영역과 겹치는 박스 및 extra 문자열은 다시 그린다. */
+   for (i = 0; i < ui_grp->r_cnt; i++) {
+      r_item = &ui_grp->r_item[i];
+      if (_ui_rect_overlap (x, y, w, h, r_item->x, r_item->y, r_item->w, r_item->h))
+         r_item->dirty = true;
+   }
+   for (i = 0; i < ui_grp->s_cnt; i++) {
+      s_item = &ui_grp->s_item[i];
+      if (!_ui_is_extra (ui_grp, s_item->r_id))
+         continue;
+      _ui_str_rect (s_item, &rect);
+      if (_ui_rect_overlap (x, y, w, h, rect.x, rect.y, rect.w, rect.h))
+         s_item->dirty = true;
+   }
 }
 
 //------------------------------------------------------------------------------
-static void _ui_update (fb_info_t *fb, ui_grp_t *ui_grp, int id)
+static void _ui_swap_box_dirty (ui_grp_t *ui_grp, int id)
 {
-   int n_rid = 0, n_sid = 0;
-
+   int n_rid = 0;
    r_item_t *r_item;
-   s_item_t *s_item;
 
-   if (id < ITEM_COUNT_MAX) {
-      while ((r_item = _ui_find_r_item(ui_grp, &n_rid, id)) != NULL) {
+   while ((r_item = _ui_find_r_item(ui_grp, &n_rid, id)) != NULL)
+      r_item->dirty = true;
+}
 
-         _ui_update_r (fb, r_item);
+//------------------------------------------------------------------------------
+/*
+   hot reload : config 정의가 같은 item은 화면에 표시중인 상태(색상, 문자열,
+   그려진 영역)를 old에서 이어받고, 정의가 바뀐 item만 dirty로 표시한다.
+*/
+static void _ui_swap_dirty (ui_grp_t *old, ui_grp_t *ui_grp)
+{
+   int i;
+   r_item_t *r_item, *o_item;
+   s_item_t *s_item, *o_str;
+
+   for (i = 0; i < ui_grp->r_cnt; i++) {
+      r_item = &ui_grp->r_item[i];
+      o_item = _ui_match_r_item (ui_grp, r_item, old);
+      if (o_item && (o_item->def == r_item->def)) {
+         r_item->bc = o_item->bc;   r_item->lc = o_item->lc;
+         r_item->dirty = false;
+      }
+      else
+         r_item->dirty = true;
+   }
 
-         n_sid = 0;
-         while ((s_item = _ui_find_s_item(ui_grp, &n_sid, id)) != NULL) {
-            if (s_item->f_type < 0)
-               s_item->f_type = ui_grp->f_type;
+   for (i = 0; i < ui_grp->s_cnt; i++) {
+      s_item = &ui_grp->s_item[i];
+      o_str  = _ui_match_s_item (ui_grp, s_item, old);
+      if (o_str && (o_str->def == s_item->def) &&
+          _ui_box_same (ui_grp, s_item->r_id, old)) {
+         memcpy (s_item, o_str, sizeof(s_item_t));
+         s_item->dirty = false;
+      }
+      else {
+         /* 박스에 속한 문자열이 바뀐 경우 이전 문자열이 남지 않도록 박스를 다시 그린다. */
+         s_item->dirty = true;
+         _ui_swap_box_dirty (ui_grp, s_item->r_id);
+      }
+   }
 
-            if ((signed)s_item->bc.uint < 0)
-               s_item->bc.uint = r_item->bc.uint;
+   /* 없어진 문자열이 있던 박스도 다시 그린다. */
+   for (i = 0; i < old->s_cnt; i++) {
+      o_str  = &old->s_item[i];
+      s_item = _ui_match_s_item (old, o_str, ui_grp);
+      if (!s_item || (s_item->def != o_str->def))
+         _ui_swap_box_dirty (ui_grp, o_str->r_id);
+   }
+}
 
-            set_font(s_item->f_type);
+//------------------------------------------------------------------------------
+/*
+   hot reload : 정의가 같은 widget은 저장된 내용을 이어받는다. (화면은 다시 그림)
+   없어진 widget이 있던 박스는 다시 그린다.
+*/
+static void _ui_swap_widget (ui_grp_t *old, ui_grp_t *ui_grp)
+{
+   int i;
+   w_item_t *w_item, *o_item;
 
-            if (s_item->scale < 0)
-               s_item->scale = _ui_str_scale (r_item->w, r_item->h, r_item->lw,
-                                             _my_strlen(s_item->str));
-            _ui_str_pos_xy(r_item, s_item);
-            _ui_update_s (fb, s_item, r_item->x, r_item->y);
-         }
-      }
+   for (i = 0; i < ui_grp->w_cnt; i++) {
+      w_item = &ui_grp->w_item[i];
+      w_item->dirty = true;
+      o_item = _ui_find_w_item (old, w_item->id);
+      if (!o_item || (o_item->def != w_item->def))
+         continue;
+      memcpy (ui_grp->w_data + w_item->data, old->w_data + o_item->data, w_item->size);
+      w_item->head  = o_item->head;    w_item->cnt = o_item->cnt;
+      w_item->v_max = o_item->v_max;
+   }
+   for (i = 0; i < old->w_cnt; i++) {
+      o_item = &old->w_item[i];
+      if (_ui_find_w_item (ui_grp, o_item->id) == NULL)
+         _ui_swap_box_dirty (ui_grp, o_item->id);
    }
-   else
-      _ui_update_extra (fb, ui_grp, id);
 }
 
 //------------------------------------------------------------------------------
-static void _ui_parser_cmd_C (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
+static void _ui_parser_cmd_C (char *buf, ui_grp_t *ui_grp)
 {
    char *ptr = strtok (buf, ",");
 
-   ptr = strtok (NULL, ",");     fb->is_bgr        = (atoi(ptr) != 0) ? 1: 0;
+   ptr = strtok (NULL, ",");     ui_grp->is_bgr    = (atoi(ptr) != 0) ? 1: 0;
    ptr = strtok (NULL, ",");     ui_grp->fc.uint   = strtol(ptr, NULL, 16);
    ptr = strtok (NULL, ",");     ui_grp->bc.uint   = strtol(ptr, NULL, 16);
    ptr = strtok (NULL, ",");     ui_grp->lc.uint   = strtol(ptr, NULL, 16);
    ptr = strtok (NULL, ",");     ui_grp->f_type    = atoi(ptr);
-
-   set_font(ui_grp->f_type);
 }
 
 //------------------------------------------------------------------------------
 static void _ui_parser_cmd_R (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
 {
    int r_cnt = ui_grp->r_cnt;
+   __u32 def = _ui_hash (2166136261u, buf, strlen(buf));
    char *ptr = strtok (buf, ",");
 
+   if (r_cnt >= ui_grp->r_max) {
+      err("Rect item overflow! (max = %d)\n", ui_grp->r_max);
+      return;
+   }
+
+   ui_grp->r_item[r_cnt].def = def;
    ptr = strtok (NULL, ",");     ui_grp->r_item[r_cnt].id   = atoi(ptr);
    ptr = strtok (NULL, ",");     ui_grp->r_item[r_cnt].x    = atoi(ptr);
    ptr = strtok (NULL, ",");     ui_grp->r_item[r_cnt].y    = atoi(ptr);
@@ -300,8 +1334,15 @@ static void _ui_parser_cmd_R (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
 static void _ui_parser_cmd_S (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
 {
    int s_cnt = ui_grp->s_cnt;
+   __u32 def = _ui_hash (2166136261u, buf, strlen(buf));
    char *ptr = strtok (buf, ",");
 
+   if (s_cnt >= ui_grp->s_max) {
+      err("String item overflow! (max = %d)\n", ui_grp->s_max);
+      return;
+   }
+
+   ui_grp->s_item[s_cnt].def = def;
    ptr = strtok (NULL, ",");     ui_grp->s_item[s_cnt].r_id    = atoi(ptr);
    ptr = strtok (NULL, ",");     ui_grp->s_item[s_cnt].x       = atoi(ptr);
    ptr = strtok (NULL, ",");     ui_grp->s_item[s_cnt].y       = atoi(ptr);
@@ -321,22 +1362,10 @@ static void _ui_parser_cmd_S (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
 
       while ((*ptr == 0x20) && slen--)
          ptr++;
-      strncpy(ui_grp->s_item[s_cnt].str, ptr, slen);
+      strncpy(ui_grp->s_item[s_cnt].str, ptr,
+               (slen < ITEM_STR_MAX) ? slen : ITEM_STR_MAX -1);
    }
    ptr = strtok (NULL, ",");     ui_grp->s_item[s_cnt].f_type = atoi(ptr);
-
-   if (ui_grp->s_item[s_cnt].r_id >= ITEM_COUNT_MAX) {
-      if (ui_grp->s_item[s_cnt].x < 0)          ui_grp->s_item[s_cnt].x = 0;
-      if (ui_grp->s_item[s_cnt].y < 0)          ui_grp->s_item[s_cnt].y = 0;
-      if (ui_grp->s_item[s_cnt].scale   < 0)    ui_grp->s_item[s_cnt].scale = 1;
-
-      if (ui_grp->s_item[s_cnt].f_type  < 0)
-         ui_grp->s_item[s_cnt].f_type  = ui_grp->f_type;
-      if (ui_grp->s_item[s_cnt].fc.uint < 0)
-         ui_grp->s_item[s_cnt].fc.uint = ui_grp->fc.uint;
-      if (ui_grp->s_item[s_cnt].bc.uint < 0)
-         ui_grp->s_item[s_cnt].bc.uint = ui_grp->bc.uint;
-   }
    s_cnt++;
    ui_grp->s_cnt = s_cnt;
 }
@@ -344,8 +1373,9 @@ static void _ui_parser_cmd_S (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
 //------------------------------------------------------------------------------
 static void _ui_parser_cmd_G (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
 {
-   int pos = ui_grp->r_cnt;
+   int pos;
    int s_h, r_h, sid, r_cnt, g_cnt, bc, lw, lc, i, j, y_s;
+   __u32 def = _ui_hash (2166136261u, buf, strlen(buf));
    char *ptr = strtok (buf, ",");
 
    ptr = strtok (NULL, ",");     sid   = atoi(ptr);
@@ -357,6 +1387,13 @@ static void _ui_parser_cmd_G (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
    ptr = strtok (NULL, ",");     lw    = atoi(ptr);
    ptr = strtok (NULL, ",");     lc    = strtol(ptr, NULL, 16);
 
+   if ((r_cnt <= 0) || (g_cnt <= 0) ||
+       (ui_grp->r_cnt + r_cnt * g_cnt > ui_grp->r_max)) {
+      err("Group item error! (r_cnt = %d, g_cnt = %d, max = %d)\n",
+            r_cnt, g_cnt, ui_grp->r_max);
+      return;
+   }
+
    for (i = 0; i < g_cnt; i++) {
       for (j = 0; j < r_cnt; j++) {
          pos = ui_grp->r_cnt + j + i * r_cnt;
@@ -365,6 +1402,7 @@ static void _ui_parser_cmd_G (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
          y_s                   = (fb->h * s_h) / 100;
          ui_grp->r_item[pos].h = (fb->h * r_h) / 100;
 
+         ui_grp->r_item[pos].def = def;
          ui_grp->r_item[pos].id = sid + j + i * r_cnt;
          ui_grp->r_item[pos].x  = ui_grp->r_item[pos].w * j;
          ui_grp->r_item[pos].y  = ui_grp->r_item[pos].h * i + y_s;
@@ -374,7 +1412,7 @@ static void _ui_parser_cmd_G (char *buf, fb_info_t *fb, ui_grp_t *ui_grp)
          ui_grp->r_item[pos].lc.uint = lc < 0 ? ui_grp->lc.uint : lc;
       }
    }
-   ui_grp->r_cnt = pos +1;
+   ui_grp->r_cnt += r_cnt * g_cnt;
 }
 
 //------------------------------------------------------------------------------
@@ -384,18 +1422,25 @@ void ui_set_ritem (fb_info_t *fb, ui_grp_t *ui_grp,
    int s_rid = 0;
    r_item_t *r_item;
 
-   if (f_id < ITEM_COUNT_MAX) {
-      /* 같은 아이디를 찾아 모두 바꾼다. */
+   if (!_ui_is_extra (ui_grp, f_id)) {
+      /* 같은 아이디를 찾아 모두 바꾼다. 색이 바뀐 경우에만 다시 그린다. */
       while ((r_item = _ui_find_r_item(ui_grp, &s_rid, f_id)) != NULL) {
-         if (bc != -1)  r_item->bc.uint = bc;   
-         if (lc != -1)  r_item->lc.uint = lc;
-         ui_set_sitem (fb, ui_grp, f_id, -1, bc, NULL);
-         ui_update (fb, ui_grp, f_id);
+         if ((bc != -1) && (r_item->bc.uint != (unsigned)bc)) {
+            r_item->bc.uint = bc;   r_item->dirty = true;
+         }
+         if ((lc != -1) && (r_item->lc.uint != (unsigned)lc)) {
+            r_item->lc.uint = lc;   r_item->dirty = true;
+         }
       }
+      ui_set_sitem (fb, ui_grp, f_id, -1, bc, NULL);
    }
 }
 
 //------------------------------------------------------------------------------
+/*
+   id 문자열의 색상/내용 변경. 바뀐 item은 ui_flush에서 다시 그려진다.
+   (fb는 다른 ui_set 함수와 호출 형식을 맞추기 위한 것으로 사용하지 않음)
+*/
 void ui_set_sitem (fb_info_t *fb, ui_grp_t *ui_grp,
                      int id, int fc, int bc, char *str)
 {
@@ -403,113 +1448,98 @@ void ui_set_sitem (fb_info_t *fb, ui_grp_t *ui_grp,
    s_item_t *s_item;
    r_item_t *r_item;
 
-   if (id < ITEM_COUNT_MAX) {
+   (void)fb;
+   if (!_ui_is_extra (ui_grp, id)) {
       while ((r_item = _ui_find_r_item(ui_grp, &n_rid, id)) != NULL) {
          n_sid = 0;
          while ((s_item = _ui_find_s_item(ui_grp, &n_sid, id)) != NULL) {
 
             /* font color 변경 */
-            if (fc != -1)
-               s_item->fc.uint = fc;
-            if (bc != -1)
-               s_item->bc.uint = bc;
-
-            /* 받아온 string을 buf에 저장 */
-            if (str != NULL)  {
-               char buf[ITEM_STR_MAX];
-
-               memset(buf, 0x00, sizeof(buf));
-
-               sprintf(buf, "%s", str);
-               /*
-                  기존 문자열 보다 새로운 문자열이 더 작은 경우
-                  기존 문자열을 배경색으로 덮어 씌운다.
-               */
-               if ((strlen(s_item->str) > strlen(buf)))
-                  _ui_clr_str (fb, r_item, s_item);
-
-               /* 새로운 string 복사 */
-               strncpy(s_item->str, buf, strlen(buf));
+            if ((fc != -1) && (s_item->fc.uint != (unsigned)fc)) {
+               s_item->fc.uint = fc;   s_item->dirty = true;
+            }
+            if ((bc != -1) && (s_item->bc.uint != (unsigned)bc)) {
+               s_item->bc.uint = bc;   s_item->dirty = true;
             }
 
+            /* 받아온 string이 기존 문자열과 다른 경우에만 저장 */
+            if ((str != NULL) && strncmp(s_item->str, str, ITEM_STR_MAX -1)) {
+               memset (s_item->str, 0x00, ITEM_STR_MAX);
+               strncpy(s_item->str, str, ITEM_STR_MAX -1);
+               s_item->dirty = true;
+            }
             _ui_str_pos_xy(r_item, s_item);
-            _ui_update_s (fb, s_item, r_item->x, r_item->y);
          }
       }
    }
 }
 
 //------------------------------------------------------------------------------
+/*
+   id 문자열의 위치/크기/글꼴/내용 변경. 바뀐 item은 ui_flush에서 다시 그려진다.
+   (fb는 다른 ui_set 함수와 호출 형식을 맞추기 위한 것으로 사용하지 않음)
+*/
 void ui_set_str (fb_info_t *fb, ui_grp_t *ui_grp,
                   int id, int x, int y, int scale, int font, char *fmt, ...)
 {
-   int n_sid = 0, n_rid = 0;
+   int n_sid = 0, n_rid = 0, o_x, o_y, o_scale, o_font;
    s_item_t *s_item;
    r_item_t *r_item;
+   va_list va;
+   char buf[ITEM_STR_MAX];
 
-   if (id < ITEM_COUNT_MAX) {
+   (void)fb;
+   /* 받아온 가변인자를 string 형태로 변환 하여 buf에 저장 */
+   memset(buf, 0x00, sizeof(buf));
+   va_start(va, fmt);   vsnprintf(buf, sizeof(buf), fmt, va); va_end(va);
+
+   if (!_ui_is_extra (ui_grp, id)) {
       while ((r_item = _ui_find_r_item(ui_grp, &n_rid, id)) != NULL) {
          n_sid = 0;
          while ((s_item = _ui_find_s_item(ui_grp, &n_sid, id)) != NULL) {
-            va_list va;
-            char buf[ITEM_STR_MAX];
-            int n_scale = s_item->scale;
-
-            /* 받아온 가변인자를 string 형태로 변환 하여 buf에 저장 */
-            memset(buf, 0x00, sizeof(buf));
-            va_start(va, fmt);   vsprintf(buf, fmt, va); va_end(va);
-
-            if (scale) {
-               /* scale = -1 이면 최대 스케일을 구하여 표시한다 */
-               if (scale < 0)
-                  n_scale = _ui_str_scale (r_item->w, r_item->h,
-                                             r_item->lw, _my_strlen(buf));
-               else
-                  n_scale = scale;
-
-               if (s_item->scale > n_scale)
-                  _ui_clr_str (fb, r_item, s_item);
-            }
+            o_x = s_item->x;  o_y = s_item->y;
+            o_scale = s_item->scale;   o_font = s_item->f_type;
 
-            if (font) {
+            /* scale = -1 이면 최대 스케일을 구하여 표시한다 */
+            if (scale)
+               s_item->scale = (scale < 0) ?
+                  _ui_str_scale (r_item, _my_strlen(buf)) :
+                  scale;
+
+            if (font)
                s_item->f_type = (font < 0) ? ui_grp->f_type : font;
-               set_font(s_item->f_type);
-            }
 
-            /*
-               기존 문자열 보다 새로운 문자열이 더 작은 경우
-               기존 문자열을 배경색으로 덮어 씌운다.
-            */
-            if ((strlen(s_item->str) > strlen(buf)) || n_scale != s_item->scale) {
-               _ui_clr_str (fb, r_item, s_item);
-               s_item->scale = n_scale;
+            /* 새로운 string 복사 */
+            if (strncmp(s_item->str, buf, ITEM_STR_MAX)) {
+               memcpy (s_item->str, buf, ITEM_STR_MAX);
+               s_item->dirty = true;
             }
             s_item->x = (x != 0) ? x : s_item->x;
-            s_item->y = (y != 0) ? x : s_item->y;
-
-            /* 새로운 string 복사 */
-            strncpy(s_item->str, buf, strlen(buf));
-
+            s_item->y = (y != 0) ? y : s_item->y;
             _ui_str_pos_xy(r_item, s_item);
-            _ui_update_s (fb, s_item, r_item->x, r_item->y);
+
+            /* 이전 상태와 같다면 다시 그리지 않는다. */
+            if ((o_x != s_item->x) || (o_y != s_item->y) ||
+                (o_scale != s_item->scale) || (o_font != s_item->f_type))
+               s_item->dirty = true;
          }
       }
    } else {
-      int i;
-      for (i = 0; i < ui_grp->s_cnt; i++) {
-         if (ui_grp->s_item[i].r_id == id) {
-            int color = ui_grp->s_item[i].fc.uint;
-
-            /* 기존 문자열을 벼경색으로 다시 그려서 지움 */
-            ui_grp->s_item[i].fc.uint = ui_grp->s_item[i].bc.uint;
-            _ui_update_s (fb, &ui_grp->s_item[i], 0, 0);
-            ui_grp->s_item[i].fc.uint = color;
-            ui_grp->s_item[i].scale = (scale > 0) ? scale : 1;
-            ui_grp->s_item[i].f_type = font;
-            ui_grp->s_item[i].x = x;
-            ui_grp->s_item[i].y = y;
-            _ui_update_s (fb, &ui_grp->s_item[i], 0, 0);
+      while ((s_item = _ui_find_s_item(ui_grp, &n_sid, id)) != NULL) {
+         o_x = s_item->x;  o_y = s_item->y;
+         o_scale = s_item->scale;   o_font = s_item->f_type;
+
+         s_item->scale  = (scale > 0) ? scale : 1;
+         s_item->f_type = (font  < 0) ? ui_grp->f_type : font;
+         s_item->x = x;
+         s_item->y = y;
+         if (strncmp(s_item->str, buf, ITEM_STR_MAX)) {
+            memcpy (s_item->str, buf, ITEM_STR_MAX);
+            s_item->dirty = true;
          }
+         if ((o_x != s_item->x) || (o_y != s_item->y) ||
+             (o_scale != s_item->scale) || (o_font != s_item->f_type))
+            s_item->dirty = true;
       }
    }
 }
@@ -522,9 +1552,224 @@ void ui_set_printf (fb_info_t *fb, ui_grp_t *ui_grp, int id, char *fmt, ...)
 
    /* 받아온 가변인자를 string 형태로 변환 하여 buf에 저장 */
    memset(buf, 0x00, sizeof(buf));
-   va_start(va, fmt);   vsprintf(buf, fmt, va); va_end(va);
+   va_start(va, fmt);   vsnprintf(buf, sizeof(buf), fmt, va); va_end(va);
+
+   /* buf를 다시 format으로 해석하지 않도록 "%s"로 넘긴다. */
+   ui_set_str (fb, ui_grp, id, -1, -1, -1, -1, "%s", buf);
+}
+
+//------------------------------------------------------------------------------
+void ui_bind (ui_bind_t *bind, int id, ui_bind_e type, int scale, const char *fmt)
+{
+   memset (bind, 0x00, sizeof(ui_bind_t));
+   bind->id    = id;
+   bind->type  = type;
+   bind->scale = scale;
+   if (fmt != NULL)
+      strncpy (bind->fmt, fmt, ITEM_STR_MAX -1);
+}
+
+//------------------------------------------------------------------------------
+/*
+   binding된 값 변경
+   ui group이 같고 값도 같다면 아무것도 하지 않는다.
+   값이 바뀐 경우에만 문자열을 만들어 ui_set_str로 넘긴다. (dirty 처리는 ui_set_str)
+*/
+static void _ui_bind_set (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind,
+                           const void *v, size_t size)
+{
+   char val[ITEM_STR_MAX];
+   __u32 u;
+
+   if (bind->valid && (bind->serial == ui_grp->serial) && !memcmp(&bind->v, v, size))
+      return;
+
+   memcpy (&bind->v, v, size);
+   bind->valid  = true;
+   bind->serial = ui_grp->serial;
+
+   switch (bind->type) {
+      case  eBIND_MAC:
+         snprintf (val, sizeof(val), "%02x:%02x:%02x:%02x:%02x:%02x",
+                  bind->v.mac[0], bind->v.mac[1], bind->v.mac[2],
+                  bind->v.mac[3], bind->v.mac[4], bind->v.mac[5]);
+         break;
+      case  eBIND_IP:
+         snprintf (val, sizeof(val), "%d.%d.%d.%d",
+                  bind->v.ip[0], bind->v.ip[1], bind->v.ip[2], bind->v.ip[3]);
+         break;
+      case  eBIND_PASS:
+         ui_set_ritem (fb, ui_grp, bind->id, bind->v.pass ? COLOR_GREEN : COLOR_RED, -1);
+         snprintf (val, sizeof(val), "%s", bind->v.pass ? "PASS" : "FAIL");
+         break;
+      case  eBIND_LATENCY:
+         /* 단위를 바꿔 유효숫자 3~4자리로 표시 */
+         u = bind->v.usec;
+         if (u < 1000)
+            snprintf (val, sizeof(val), "%u us", u);
+         else if (u < 1000000)
+            snprintf (val, sizeof(val), "%u.%02u ms", u / 1000, (u % 1000) / 10);
+         else
+            snprintf (val, sizeof(val), "%u.%02u s", u / 1000000, (u % 1000000) / 10000);
+         break;
+      case  eBIND_INT:
+         if (bind->fmt[0])
+            ui_set_str (fb, ui_grp, bind->id, -1, -1, bind->scale, -1,
+                        bind->fmt, bind->v.i);
+         return;
+      default :
+         return;
+   }
+   if (bind->fmt[0])
+      ui_set_str (fb, ui_grp, bind->id, -1, -1, bind->scale, -1, bind->fmt, val);
+}
+
+//------------------------------------------------------------------------------
+void ui_bind_int (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind, int v)
+{
+   _ui_bind_set (fb, ui_grp, bind, &v, sizeof(v));
+}
+
+//------------------------------------------------------------------------------
+void ui_bind_mac (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind, const __u8 *mac)
+{
+   _ui_bind_set (fb, ui_grp, bind, mac, sizeof(bind->v.mac));
+}
+
+//------------------------------------------------------------------------------
+void ui_bind_ip (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind, const __u8 *ip)
+{
+   _ui_bind_set (fb, ui_grp, bind, ip, sizeof(bind->v.ip));
+}
+
+//------------------------------------------------------------------------------
+void ui_bind_pass (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind, bool pass)
+{
+   _ui_bind_set (fb, ui_grp, bind, &pass, sizeof(pass));
+}
+
+//------------------------------------------------------------------------------
+void ui_bind_usec (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind, __u32 usec)
+{
+   _ui_bind_set (fb, ui_grp, bind, &usec, sizeof(usec));
+}
+
+//------------------------------------------------------------------------------
+/*
+   id의 LOG widget에 한 줄을 추가한다. (ring buffer가 가득 차면 오래된 줄을 버림)
+   화면에는 ui_flush에서 새 줄만 그려진다.
+   (fb는 다른 ui_set 함수와 호출 형식을 맞추기 위한 것으로 사용하지 않음)
+*/
+void ui_log (fb_info_t *fb, ui_grp_t *ui_grp, int id, char *fmt, ...)
+{
+   int i;
+   w_item_t *w_item;
+   va_list va;
+   char buf[ITEM_STR_MAX];
+
+   (void)fb;
+   memset(buf, 0x00, sizeof(buf));
+   va_start(va, fmt);   vsnprintf(buf, sizeof(buf), fmt, va); va_end(va);
+
+   for (i = 0; i < ui_grp->w_cnt; i++) {
+      w_item = &ui_grp->w_item[i];
+      if ((w_item->id != id) || (w_item->type != eWIDGET_LOG))
+         continue;
+
+      memcpy (ui_grp->w_data + w_item->data + w_item->head * ITEM_STR_MAX,
+               buf, ITEM_STR_MAX);
+      w_item->head = (w_item->head + 1) % w_item->rows;
+      if (w_item->cnt     < w_item->rows)    w_item->cnt++;
+      if (w_item->pending < w_item->rows)    w_item->pending++;
+   }
+}
+
+//------------------------------------------------------------------------------
+/* 자동 세로축 최대값 (value 이상의 2의 거듭제곱, 자주 바뀌지 않도록 함) */
+static int _ui_w_range (int value)
+{
+   int range = 1;
+
+   while ((range < value) && (range < (INT_MAX / 2)))
+      range <<= 1;
+   return range;
+}
+
+//------------------------------------------------------------------------------
+/*
+   id의 SPARK/HIST widget에 sample을 추가한다.
+   HIST는 들어온 sample과 ring buffer에서 밀려난 sample의 막대만 바뀐다.
+   자동 최대값이 바뀐 경우에만 widget 전체를 다시 그린다. (fb는 사용하지 않음)
+*/
+void ui_sample (fb_info_t *fb, ui_grp_t *ui_grp, int id, int value)
+{
+   int i, k, old, peak, *samples, *bins;
+   bool full;
+   w_item_t *w_item;
+
+   (void)fb;
+   for (i = 0; i < ui_grp->w_cnt; i++) {
+      w_item = &ui_grp->w_item[i];
+      if ((w_item->id != id) ||
+          ((w_item->type != eWIDGET_SPARK) && (w_item->type != eWIDGET_HIST)))
+         continue;
+
+      samples = _ui_w_samples (ui_grp, w_item);
+      bins    = samples + w_item->rows;
+      full    = (w_item->cnt == w_item->rows);
+      old     = samples[w_item->head];
+
+      samples[w_item->head] = value;
+      w_item->head = (w_item->head + 1) % w_item->rows;
+      if (w_item->cnt     < w_item->rows)    w_item->cnt++;
+      if (w_item->pending < w_item->rows)    w_item->pending++;
+
+      if (w_item->max <= 0) {
+         for (k = 0, peak = 0; k < w_item->cnt; k++)
+            if (samples[k] > peak)
+               peak = samples[k];
+         if ((peak = _ui_w_range (peak)) != w_item->v_max) {
+            w_item->v_max = peak;
+            w_item->dirty = true;
+            if (w_item->type == eWIDGET_HIST)
+               _ui_w_hist_count (ui_grp, w_item);
+            continue;
+         }
+      }
+      if (w_item->type == eWIDGET_HIST) {
+         if (full) {
+            k = _ui_w_bin (w_item, old);
+            bins[k]--;  w_item->bin_dirty |= (1ULL << k);
+         }
+         k = _ui_w_bin (w_item, value);
+         bins[k]++;  w_item->bin_dirty |= (1ULL << k);
+      }
+   }
+}
+
+//------------------------------------------------------------------------------
+/*
+   id의 GRID widget에서 cell 번째 셀의 색상을 바꾼다.
+   색상이 바뀐 셀만 다음 ui_flush에서 다시 그린다. (fb는 사용하지 않음)
+*/
+void ui_cell (fb_info_t *fb, ui_grp_t *ui_grp, int id, int cell, int color)
+{
+   int i, *colors;
+   w_item_t *w_item;
+
+   (void)fb;
+   for (i = 0; i < ui_grp->w_cnt; i++) {
+      w_item = &ui_grp->w_item[i];
+      if ((w_item->id != id) || (w_item->type != eWIDGET_GRID) ||
+          (cell < 0) || (cell >= w_item->rows))
+         continue;
 
-   ui_set_str (fb, ui_grp, id, -1, -1, -1, -1, buf);
+      colors = _ui_w_samples (ui_grp, w_item);
+      if (colors[cell] != color) {
+         colors[cell] = color;
+         w_item->pending = 1;
+      }
+   }
 }
 
 //------------------------------------------------------------------------------
@@ -535,44 +1780,259 @@ void ui_update (fb_info_t *fb, ui_grp_t *ui_grp, int id)
 
    /* ui_grp에 등록되어있는 모든 item에 대하여 화면 업데이트 함 */
    if (id < 0) {
-      /* 사각형 item에 대한 화면 업데이트 */
-      for (i = 0; i < ui_grp->r_cnt; i++)
+      /* 색인된 모든 id (박스 및 extra 문자열) 에 대한 화면 업데이트 */
+      for (i = 0; i < ui_grp->id_cnt; i++)
          _ui_update (fb, ui_grp, i);
-
-      /* 문자열 item에 대한 화면 업데이트 */
-      for (i = 0; i < ui_grp->s_cnt; i++) {
-         if (ui_grp->s_item[i].r_id >= ITEM_COUNT_MAX)
-            _ui_update_s (fb, &ui_grp->s_item[i], 0, 0);
-      }
    }
    else  /* id값으로 설정된 1 개의 item에 대한 화면 업데이트 */
       _ui_update (fb, ui_grp, id);
 
 }
 
+//------------------------------------------------------------------------------
+/*
+   ui_set_xxx 함수는 item의 내용이 바뀐 경우 dirty 표시만 하며 화면에 그리지 않는다.
+   화면 갱신 주기마다 ui_flush를 한번 호출하여 바뀐 item만 다시 그린다.
+   (내용이 바뀌지 않았다면 화면에 쓰는 pixel은 없음)
+*/
+void ui_flush (fb_info_t *fb, ui_grp_t *ui_grp)
+{
+   int i, n_sid;
+   r_item_t *r_item;
+   s_item_t *s_item;
+
+   for (i = 0; i < ui_grp->r_cnt; i++) {
+      r_item = &ui_grp->r_item[i];
+
+      /* 박스를 다시 그린 경우 박스에 속한 문자열 및 widget은 모두 다시 그린다. */
+      if (r_item->dirty) {
+         _ui_update_r (fb, r_item);
+         _ui_w_dirty (ui_grp, r_item->id);
+      }
+
+      n_sid = 0;
+      while ((s_item = _ui_find_s_item(ui_grp, &n_sid, r_item->id)) != NULL) {
+         if (r_item->dirty)
+            _ui_update_s (fb, s_item, r_item);
+         else if (s_item->dirty)
+            _ui_redraw_s (fb, s_item, r_item);
+      }
+      r_item->dirty = false;
+   }
+
+   for (i = 0; i < ui_grp->s_cnt; i++) {
+      s_item = &ui_grp->s_item[i];
+      if (s_item->dirty && _ui_is_extra (ui_grp, s_item->r_id))
+         _ui_redraw_s (fb, s_item, NULL);
+      s_item->dirty = false;
+   }
+
+   for (i = 0; i < ui_grp->w_cnt; i++)
+      _ui_update_w (fb, ui_grp, &ui_grp->w_item[i]);
+}
+
 //------------------------------------------------------------------------------
 void ui_close (ui_grp_t *ui_grp)
 {
    /* 할당받은 메모리가 있다면 시스템으로 반환한다. */
-   if (ui_grp)
+   /* item 및 색인 배열은 ui_grp와 함께 할당되어 있음. */
+   if (ui_grp == NULL)
+      return;
+
+   if (ui_grp->map)
+      munmap (ui_grp->map, ui_grp->map_size);
+   else
       free (ui_grp);
 }
 
 //------------------------------------------------------------------------------
-ui_grp_t *ui_init (fb_info_t *fb, const char *cfg_filename)
+/*
+   hot reload : 새로 읽은 ui_grp를 현재 표시중인 old와 비교하여
+   없어지거나 바뀐 영역은 지우고 바뀐 item만 dirty로 표시한다.
+   호출 후 old는 ui_close로 해제하고, ui_flush로 화면에 반영한다.
+*/
+void ui_swap (fb_info_t *fb, ui_grp_t *old, ui_grp_t *ui_grp)
 {
-   ui_grp_t	*ui_grp;
+   int i;
+   r_item_t *r_item, *o_item;
+   s_item_t *s_item, *o_str;
+
+   /* 기본 설정(C command)이 바뀐 경우 전체 화면을 다시 그린다. */
+   if ((old->is_bgr  != ui_grp->is_bgr)  || (old->f_type != ui_grp->f_type) ||
+       (old->fc.uint != ui_grp->fc.uint) || (old->bc.uint != ui_grp->bc.uint) ||
+       (old->lc.uint != ui_grp->lc.uint)) {
+      fb_set_bgr (fb, ui_grp->is_bgr);
+      fb_clear (fb);
+      _ui_swap_widget (old, ui_grp);
+      ui_update (fb, ui_grp, -1);
+      return;
+   }
+
+   _ui_swap_dirty (old, ui_grp);
+   _ui_swap_widget (old, ui_grp);
+
+   /* 없어지거나 정의가 바뀐 박스 영역을 지운다. */
+   for (i = 0; i < old->r_cnt; i++) {
+      o_item = &old->r_item[i];
+      r_item = _ui_match_r_item (old, o_item, ui_grp);
+      if (r_item && (r_item->def == o_item->def))
+         continue;
+      draw_fill_rect (fb, o_item->x, o_item->y, o_item->w, o_item->h, 0);
+      _ui_swap_touch (ui_grp, o_item->x, o_item->y, o_item->w, o_item->h);
+   }
+
+   /* 없어지거나 정의가 바뀐 extra 문자열 영역을 지운다. */
+   for (i = 0; i < old->s_cnt; i++) {
+      o_str = &old->s_item[i];
+      if (!_ui_is_extra (old, o_str->r_id))
+         continue;
+      s_item = _ui_match_s_item (old, o_str, ui_grp);
+      if (s_item && (s_item->def == o_str->def) && !s_item->dirty)
+         continue;
+      draw_fill_rect (fb, o_str->drawn.x, o_str->drawn.y,
+                        o_str->drawn.w, o_str->drawn.h, o_str->bc.uint);
+      _ui_swap_touch (ui_grp, o_str->drawn.x, o_str->drawn.y,
+                        o_str->drawn.w, o_str->drawn.h);
+   }
+}
+
+//------------------------------------------------------------------------------
+static int _ui_widget_type (char *ptr)
+{
+   int i, len;
+
+   /* 앞/뒤 공백 제외 후 widget 이름 비교 */
+   while (*ptr == 0x20)
+      ptr++;
+   for (len = 0; ptr[len] && (ptr[len] != 0x20) && (ptr[len] != '\n'); len++)
+      ;
+   for (i = 0; i < eWIDGET_END; i++)
+      if ((strlen(UiWidgetName[i]) == (size_t)len) && !strncmp (UiWidgetName[i], ptr, len))
+         return i;
+   return -1;
+}
+
+//------------------------------------------------------------------------------
+/* widget ring buffer 크기 (byte), 설정이 잘못된 경우 0 */
+static int _ui_widget_size (int type, int rows, int bins)
+{
+   if (rows <= 0)
+      return 0;
+
+   switch (type) {
+      case  eWIDGET_LOG:   return rows * ITEM_STR_MAX;
+      case  eWIDGET_SPARK: return rows * (int)sizeof(int);
+      case  eWIDGET_GRID:
+         return (rows > UI_GRID_CELLS_MAX) ? 0 : rows * 2 * (int)sizeof(int);
+      case  eWIDGET_HIST:
+         if ((bins <= 0) || (bins > UI_HIST_BINS_MAX))
+            return 0;
+         return (rows + bins) * (int)sizeof(int);
+      default :
+         return 0;
+   }
+}
+
+//------------------------------------------------------------------------------
+static void _ui_parser_cmd_W (char *buf, ui_grp_t *ui_grp)
+{
+   int w_cnt = ui_grp->w_cnt;
+   w_item_t *w_item = &ui_grp->w_item[w_cnt], *prev = w_item - 1;
+   __u32 def = _ui_hash (2166136261u, buf, strlen(buf));
+   char *ptr = strtok (buf, ",");
+
+   if (w_cnt >= ui_grp->w_max) {
+      err("Widget item overflow! (max = %d)\n", ui_grp->w_max);
+      return;
+   }
+
+   w_item->def = def;
+   ptr = strtok (NULL, ",");     w_item->id      = atoi(ptr);
+   ptr = strtok (NULL, ",");     w_item->type    = ptr ? _ui_widget_type(ptr) : -1;
+   ptr = strtok (NULL, ",");     w_item->rows    = ptr ? atoi(ptr) : 0;
+   ptr = strtok (NULL, ",");     w_item->scale   = atoi(ptr);
+   ptr = strtok (NULL, ",");     w_item->fc.uint = strtoul(ptr, NULL, 16);
+   ptr = strtok (NULL, ",");     w_item->bc.uint = strtoul(ptr, NULL, 16);
+   ptr = strtok (NULL, ",");     w_item->f_type  = ptr ? atoi(ptr) : 0;
+
+   /* GRID : rows = 셀 개수, scale = 열 개수 (셀 번호는 1배 크기로 표시) */
+   if (w_item->type == eWIDGET_GRID) {
+      w_item->bins   = (w_item->scale > 0) ? w_item->scale : 16;
+      w_item->scale  = 1;
+      w_item->f_type = -1;
+   }
+   /* SPARK/HIST : scale = 세로축 최대값, fn = 막대 개수(HIST) */
+   else if (w_item->type != eWIDGET_LOG) {
+      w_item->max    = w_item->scale;
+      w_item->bins   = (w_item->type == eWIDGET_HIST) ? w_item->f_type : 0;
+      w_item->scale  = 1;
+      w_item->f_type = -1;
+   }
+
+   /* widget ring buffer 저장 공간은 선언된 순서대로 나누어 사용 */
+   w_item->data = w_cnt ? (prev->data + prev->size) : 0;
+   w_item->size = _ui_widget_size (w_item->type, w_item->rows, w_item->bins);
+
+   if ((w_item->size <= 0) || (w_item->data + w_item->size > ui_grp->w_bytes)) {
+      err("Widget config error! (id = %d, type = %d, rows = %d)\n",
+            w_item->id, w_item->type, w_item->rows);
+      memset (w_item, 0x00, sizeof(w_item_t));
+      return;
+   }
+   w_cnt++;
+   ui_grp->w_cnt = w_cnt;
+}
+
+//------------------------------------------------------------------------------
+/*
+   config 파일을 읽어 배치가 끝난 ui_grp를 만든다. (화면에는 그리지 않음)
+   fb는 해상도 정보만 사용하므로 별도의 thread에서 호출 할 수 있다.
+*/
+ui_grp_t *ui_load (fb_info_t *fb, const char *cfg_filename)
+{
+   ui_grp_t	*ui_grp, cnt;
    FILE *pfd;
-   char buf[256], r_cnt = 0, s_cnt = 0, *ptr, is_cfg_file = 0;
+   char buf[256], is_cfg_file = 0;
+   bool use_cache = (getenv("UI_NO_CACHE") == NULL);
+   __u32 hash, cfg_size;
+   size_t size;
 
    if ((pfd = fopen(cfg_filename, "r")) == NULL)
       return   NULL;
 
-	if ((ui_grp = (ui_grp_t *)malloc(sizeof(ui_grp_t))) == NULL)
+   /* config 내용과 fb 해상도가 같다면 이전에 저장된 layout을 그대로 사용 */
+   hash = _ui_cfg_hash (pfd, &cfg_size);
+   if (use_cache &&
+       (ui_grp = _ui_cache_load (fb, cfg_filename, hash, cfg_size)) != NULL) {
+      fclose (pfd);
+      ui_grp->serial = __atomic_add_fetch (&UiSerial, 1, __ATOMIC_RELAXED);
+      return ui_grp;
+   }
+   rewind (pfd);
+
+   /* 1차 : item 개수를 구하여 저장 공간을 한번에 할당한다. */
+   if (!_ui_count_items (pfd, &cnt)) {
+      err("UI Config File not found! (filename = %s)\n", cfg_filename);
+      fclose (pfd);
+      return NULL;
+   }
+
+   size = _ui_grp_size (&cnt);
+	if ((ui_grp = (ui_grp_t *)calloc(1, size)) == NULL) {
+      err("UI memory allocation fail! (size = %zu)\n", size);
+      fclose (pfd);
       return   NULL;
+   }
+   ui_grp->r_max   = cnt.r_max;
+   ui_grp->s_max   = cnt.s_max;
+   ui_grp->w_max   = cnt.w_max;
+   ui_grp->w_bytes = cnt.w_bytes;
+   ui_grp->id_cnt  = cnt.id_cnt;
+   _ui_grp_layout (ui_grp);
 
-   memset (ui_grp, 0x00, sizeof(ui_grp_t));
-   memset (buf,    0x00, sizeof(buf));
+   /* 2차 : item 설정 */
+   rewind (pfd);
+   memset (buf, 0x00, sizeof(buf));
 
    while(fgets(buf, sizeof(buf), pfd) != NULL) {
       if (!is_cfg_file) {
@@ -581,10 +2041,11 @@ ui_grp_t *ui_init (fb_info_t *fb, const char *cfg_filename)
          continue;
       }
       switch(buf[0]) {
-         case  'C':  _ui_parser_cmd_C (buf, fb, ui_grp); break;
+         case  'C':  _ui_parser_cmd_C (buf, ui_grp); break;
          case  'R':  _ui_parser_cmd_R (buf, fb, ui_grp); break;
          case  'S':  _ui_parser_cmd_S (buf, fb, ui_grp); break;
          case  'G':  _ui_parser_cmd_G (buf, fb, ui_grp); break;
+         case  'W':  _ui_parser_cmd_W (buf, ui_grp); break;
          default :
             err("Unknown parser command! cmd = %c\n", buf[0]);
          case  '#':  case  '\n':
@@ -592,21 +2053,35 @@ ui_grp_t *ui_init (fb_info_t *fb, const char *cfg_filename)
       }
       memset (buf, 0x00, sizeof(buf));
    }
+   fclose (pfd);
 
-   if (!is_cfg_file) {
-      err("UI Config File not found! (filename = %s)\n", cfg_filename);
-      free (ui_grp);
+   /* id -> item 색인 생성 후 기본값(-1)으로 설정된 항목 계산 */
+   _ui_build_index (ui_grp);
+   _ui_resolve (ui_grp);
+
+   /* auto scale 및 문자열 위치 계산이 끝난 상태를 저장 */
+   if (use_cache)
+      _ui_cache_save (fb, ui_grp, cfg_filename, hash, cfg_size);
+
+   ui_grp->serial = __atomic_add_fetch (&UiSerial, 1, __ATOMIC_RELAXED);
+
+	return	ui_grp;
+}
+
+//------------------------------------------------------------------------------
+ui_grp_t *ui_init (fb_info_t *fb, const char *cfg_filename)
+{
+   ui_grp_t	*ui_grp;
+
+   if ((ui_grp = ui_load (fb, cfg_filename)) == NULL)
       return NULL;
-   }
+
+   fb_set_bgr (fb, ui_grp->is_bgr);
 
    /* all item update */
-   if (ui_grp->r_cnt)
+   if (ui_grp->r_cnt || ui_grp->s_cnt)
       ui_update (fb, ui_grp, -1);
 
-   if (pfd)
-      fclose (pfd);
-
-	// file parser
 	return	ui_grp;
 }
 
@@ -18,7 +18,6 @@
 #include "lib_fb.h"
 
 //------------------------------------------------------------------------------
-#define	ITEM_COUNT_MAX	64
 #define	ITEM_STR_MAX	64
 #define	ITEM_SCALE_MAX	100
 
@@ -26,21 +25,136 @@
 typedef struct rect_item__t {
 	int				id, x, y, w, h, lw;
 	fb_color_u		bc, lc;
+	/* 내용이 바뀌어 ui_flush에서 다시 그려야 하는 item */
+	bool			dirty;
+	/* item을 정의한 config 라인의 hash (hot reload시 비교) */
+	__u32			def;
+	/* 마지막 auto scale 결과 (as_len = 문자열 길이 +1, 0이면 없음) */
+	int				as_len, as_scale;
 }	r_item_t;
 
 typedef struct string_item__t {
 	int				r_id, x, y, scale, f_type;
 	fb_color_u		fc, bc;
 	char            str[ITEM_STR_MAX];
+	bool			dirty;
+	/* 마지막으로 화면에 그려진 문자열 영역 (r_item 기준 좌표) */
+	fb_rect_t		drawn;
+	/* 마지막으로 화면에 그려진 문자열 및 속성 (바뀐 글자만 다시 그릴 때 비교) */
+	char			d_str[ITEM_STR_MAX];
+	int				d_scale, d_font;
+	fb_color_u		d_fc, d_bc;
+	__u32			def;
 }	s_item_t;
 
+/* widget 종류 (W command) */
+enum eUI_WIDGET {
+	eWIDGET_LOG = 0,	/* 문자열 log (마지막 rows 줄 표시, ui_log)        */
+	eWIDGET_SPARK,		/* 마지막 rows 개 sample의 막대 그래프 (ui_sample) */
+	eWIDGET_HIST,		/* 마지막 rows 개 sample의 분포 (ui_sample)        */
+	eWIDGET_GRID,		/* rows 개 셀을 scale 열로 배치한 색상 표 (ui_cell) */
+	eWIDGET_END
+};
+
+/* HIST widget의 최대 막대 개수 (bin_dirty bit 수) */
+#define	UI_HIST_BINS_MAX	64
+/* GRID widget의 최대 셀 개수 */
+#define	UI_GRID_CELLS_MAX	256
+
+typedef struct widget_item__t {
+	int				id, type, rows, scale, f_type;
+	fb_color_u		fc, bc;
+	/*
+		ring buffer (ui_grp->w_data의 byte 단위 위치 및 크기)
+		LOG   : char [rows][ITEM_STR_MAX]
+		SPARK : int  [rows] (sample)
+		HIST  : int  [rows] (sample) + int [bins] (막대별 sample 수)
+		GRID  : int  [rows] (셀 색상) + int [rows] (화면에 그려진 셀 색상)
+		head = 다음에 쓸 위치, cnt = 저장된 개수
+	*/
+	int				data, size, head, cnt;
+	/* 화면에 표시중인 line 수, 아직 그려지지 않은 새 line(sample) 수 */
+	int				shown, pending;
+	/*
+		SPARK/HIST : 설정된 최대값(0 이하면 자동), 현재 세로축 최대값, 막대 개수
+		GRID       : bins = 열 개수
+	*/
+	int				max, v_max, bins;
+	unsigned long long	bin_dirty;
+	/* 박스가 다시 그려져 전체를 다시 그려야 하는 경우 */
+	bool			dirty;
+	__u32			def;
+}	w_item_t;
+
 typedef struct ui_group__t {
 	int             r_cnt, s_cnt, f_type;
     fb_color_u      fc, bc, lc;
-	r_item_t		r_item[ITEM_COUNT_MAX];
-	s_item_t		s_item[ITEM_COUNT_MAX];
+	bool			is_bgr;
+
+	/*
+		item 저장 공간은 ui_init에서 config 파일을 한번 읽어 크기를 구한 후
+		ui_grp_t 뒤에 한번에 할당한다. (r_max, s_max, w_max = 할당된 item 개수)
+	*/
+	int				r_max, s_max;
+	r_item_t		*r_item;
+	s_item_t		*s_item;
+
+	/* widget item 및 widget ring buffer 저장 공간 (w_bytes) */
+	int				w_cnt, w_max, w_bytes;
+	w_item_t		*w_item;
+	char			*w_data;
+
+	/*
+		id 별 item 색인 (CSR 형태, ui_init에서 생성)
+		id의 r_item 목록 : r_idx[r_off[id]] ~ r_idx[r_off[id+1] -1]
+		id의 s_item 목록 : s_idx[s_off[id]] ~ s_idx[s_off[id+1] -1]
+	*/
+	int				id_cnt;
+	int				*r_off, *r_idx;
+	int				*s_off, *s_idx;
+
+	/* layout cache 파일을 mmap하여 사용하는 경우 (ui_close에서 munmap) */
+	void			*map;
+	size_t			map_size;
+
+	/* ui_load 마다 바뀌는 번호 (hot reload 후 binding 값을 다시 표시) */
+	__u32			serial;
 }	ui_grp_t;
 
+//------------------------------------------------------------------------------
+/*
+	UI item value binding
+	item id에 값의 형식과 format을 연결해 두고 원래 값을 넘기면,
+	이전 값과 비교하여 바뀐 경우에만 문자열을 만들고 다시 그린다.
+	fmt에는 변환된 값이 하나 들어간다. (eBIND_INT는 "%d", 나머지는 "%s")
+*/
+typedef enum ui_bind__e {
+	eBIND_INT = 0,	/* int                : 예) "%d MB/s"                    */
+	eBIND_MAC,		/* __u8[6]            : "00:1e:06:xx:xx:xx"             */
+	eBIND_IP,		/* __u8[4]            : "192.168.0.2"                   */
+	eBIND_PASS,		/* bool               : "PASS"/"FAIL", 박스 색 변경      */
+	eBIND_LATENCY,	/* __u32 (usec)       : "850 us", "1.25 ms", "2.00 s"   */
+	eBIND_END
+}	ui_bind_e;
+
+typedef struct ui_bind__t {
+	int				id, scale;
+	ui_bind_e		type;
+	/* NULL(빈 문자열)이면 문자열은 바꾸지 않는다. (eBIND_PASS의 색 변경만 사용) */
+	char			fmt[ITEM_STR_MAX];
+
+	/* 마지막으로 표시한 값과 ui group */
+	bool			valid;
+	__u32			serial;
+	union {
+		int			i;
+		__u8		mac[6];
+		__u8		ip[4];
+		bool		pass;
+		__u32		usec;
+	}	v;
+}	ui_bind_t;
+
 //------------------------------------------------------------------------------
 extern	void        ui_set_ritem(fb_info_t *fb, ui_grp_t *ui_grp,
                                     int f_id, int bc, int lc);
@@ -50,8 +164,25 @@ extern	void        ui_set_str	(fb_info_t *fb, ui_grp_t *ui_grp,
                     	int id, int x, int y, int scale, int font, char *fmt, ...);
 extern	void        ui_set_printf	(fb_info_t *fb, ui_grp_t *ui_grp,
                                  		int id, char *fmt, ...);
+extern	void        ui_bind     (ui_bind_t *bind, int id, ui_bind_e type,
+									int scale, const char *fmt);
+extern	void        ui_bind_int (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind, int v);
+extern	void        ui_bind_mac (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind,
+									const __u8 *mac);
+extern	void        ui_bind_ip  (fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind,
+									const __u8 *ip);
+extern	void        ui_bind_pass(fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind,
+									bool pass);
+extern	void        ui_bind_usec(fb_info_t *fb, ui_grp_t *ui_grp, ui_bind_t *bind,
+									__u32 usec);
+extern	void        ui_log      (fb_info_t *fb, ui_grp_t *ui_grp, int id, char *fmt, ...);
+extern	void        ui_sample   (fb_info_t *fb, ui_grp_t *ui_grp, int id, int value);
+extern	void        ui_cell     (fb_info_t *fb, ui_grp_t *ui_grp, int id, int cell, int color);
 extern	void        ui_update   (fb_info_t *fb, ui_grp_t *ui_grp, int id);
+extern	void        ui_flush    (fb_info_t *fb, ui_grp_t *ui_grp);
+extern	void        ui_swap     (fb_info_t *fb, ui_grp_t *old, ui_grp_t *ui_grp);
 extern	void        ui_close    (ui_grp_t *ui_grp);
+extern	ui_grp_t	*ui_load    (fb_info_t *fb, const char *cfg_filename);
 extern	ui_grp_t	*ui_init    (fb_info_t *fb, const char *cfg_filename);
 
 //------------------------------------------------------------------------------
@@ -16,6 +16,9 @@
 #include <string.h>
 #include <time.h>
 #include <getopt.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <limits.h>
 
 //------------------------------------------------------------------------------
 // for my lib
@@ -29,6 +32,9 @@
 /* file parser control 함수 */
 #include "lib_ui.h"
 
+/* i2c-dev adapter handle 함수 */
+#include "lib_i2c.h"
+
 //------------------------------------------------------------------------------
 // Application header file
 //------------------------------------------------------------------------------
@@ -37,8 +43,16 @@
 //------------------------------------------------------------------------------
 // Default global value
 //------------------------------------------------------------------------------
-const char	*OPT_UI_CFG_FILE	= "default_ui.cfg";
+const char	*OPT_UI_CFG_FILE	= NULL;
 const char	*OPT_APP_CFG_FILE 	= "default_app.cfg";
+const char	*OPT_FB_DEVICE		= NULL;
+bool		OPT_SCAN_MODE		= false;
+const char	*OPT_LAT_FILE		= NULL;
+int			OPT_SOAK_SEC		= 0;
+
+/* ui config 파일이 지정되지 않은 경우 */
+#define	DEFAULT_UI_CFG_FILE		"default_ui.cfg"
+#define	SCAN_UI_CFG_FILE		"scan_ui.cfg"
 
 //------------------------------------------------------------------------------
 // function prototype define
@@ -58,9 +72,15 @@ static void toupperstr (char *p)
 //------------------------------------------------------------------------------
 static void print_usage(const char *prog)
 {
-	printf("Usage: %s [-fu]\n", prog);
+	printf("Usage: %s [-fudslk]\n", prog);
 	puts("  -f --app_cfg_file    default name is default_app.cfg.\n"
-		 "  -u --ui_cfg_file     default name is default_ui.cfg\n"
+		 "  -u --ui_cfg_file     default name is default_ui.cfg (scan mode : scan_ui.cfg)\n"
+		 "  -d --fb_device       override FB device of app config.\n"
+		 "                       (/dev/fbX, mem:{w}x{h}x{bpp}, file:{path}:{w}x{h}x{bpp})\n"
+		 "  -s --scan            scan all address(0x03~0x77) of i2c adapters.\n"
+		 "  -l --lat_file        export i2c transfer latency histogram every second.\n"
+		 "  -k --soak {sec}      back-to-back transfers on every i2c adapter for {sec} seconds.\n"
+		 "                       (transfer mix = SOAK in app config, exit code 1 if any error)\n"
 	);
 	exit(1);
 }
@@ -72,11 +92,15 @@ static void parse_opts (int argc, char *argv[])
 		static const struct option lopts[] = {
 			{ "app_config_file"	, 1, 0, 'f' },
 			{ "ui_config_file"	, 1, 0, 'u' },
+			{ "fb_device"		, 1, 0, 'd' },
+			{ "scan"			, 0, 0, 's' },
+			{ "lat_file"		, 1, 0, 'l' },
+			{ "soak"			, 1, 0, 'k' },
 			{ NULL, 0, 0, 0 },
 		};
 		int c;
 
-		c = getopt_long(argc, argv, "f:u:", lopts, NULL);
+		c = getopt_long(argc, argv, "f:u:d:sl:k:", lopts, NULL);
 
 		if (c == -1)
 			break;
@@ -88,6 +112,20 @@ static void parse_opts (int argc, char *argv[])
 		case 'u':
 			OPT_UI_CFG_FILE = optarg;
 			break;
+		case 'd':
+			OPT_FB_DEVICE = optarg;
+			break;
+		case 's':
+			OPT_SCAN_MODE = true;
+			break;
+		case 'l':
+			OPT_LAT_FILE = optarg;
+			break;
+		case 'k':
+			OPT_SOAK_SEC = atoi(optarg);
+			if (OPT_SOAK_SEC <= 0)
+				print_usage(argv[0]);
+			break;
 		default:
 			print_usage(argv[0]);
 			break;
@@ -133,57 +171,170 @@ void _parse_fb_config (app_data_t *app_data)
 //------------------------------------------------------------------------------
 #define I2C_BUS_NAME		"/sys/bus/i2c/devices/"
 
-void _parse_i2c_config (app_data_t *app_data)
+/* sysfs 에서 찾은 adapter (i2c-N) */
+typedef struct i2c_adapter__t {
+	int		nr;
+	char	name[64];
+}	i2c_adapter_t;
+
+//------------------------------------------------------------------------------
+static int _i2c_adapter_cmp (const void *a, const void *b)
+{
+	return ((const i2c_adapter_t *)a)->nr - ((const i2c_adapter_t *)b)->nr;
+}
+
+//------------------------------------------------------------------------------
+/*
+	I2C_BUS_NAME 을 한번 읽어 adapter(i2c-N) 목록을 번호 순으로 만든다.
+	(N-00xx 형태의 client device 항목은 제외, 반환된 목록은 호출한 곳에서 free)
+*/
+static i2c_adapter_t *_i2c_adapter_list (int *cnt)
+{
+	DIR *dir;
+	struct dirent *ent;
+	i2c_adapter_t *list = NULL, *p;
+	char path[PATH_MAX];
+	int max = 0, nr;
+	FILE *fp;
+
+	*cnt = 0;
+	if ((dir = opendir(I2C_BUS_NAME)) == NULL) {
+		err ("%s open fail!\n", I2C_BUS_NAME);
+		return NULL;
+	}
+	while ((ent = readdir(dir)) != NULL) {
+		if (sscanf(ent->d_name, "i2c-%d", &nr) != 1)
+			continue;
+		if (*cnt >= max) {
+			max = max ? max * 2 : 16;
+			if ((p = realloc(list, max * sizeof(i2c_adapter_t))) == NULL)
+				break;
+			list = p;
+		}
+		p = &list[*cnt];
+		memset (p, 0x00, sizeof(i2c_adapter_t));
+		p->nr = nr;
+
+		snprintf(path, sizeof(path), "%s%s/name", I2C_BUS_NAME, ent->d_name);
+		if ((fp = fopen(path, "r")) != NULL) {
+			if (fgets(p->name, sizeof(p->name), fp) != NULL)
+				p->name[strcspn(p->name, "\n")] = 0x00;
+			fclose(fp);
+		}
+		(*cnt)++;
+	}
+	closedir(dir);
+
+	if (*cnt)
+		qsort(list, *cnt, sizeof(i2c_adapter_t), _i2c_adapter_cmp);
+	return list;
+}
+
+//------------------------------------------------------------------------------
+/*
+	adapter 이름 pattern (fnmatch) 또는 이름의 앞부분이 같거나,
+	node 이름(i2c-N)이 pattern과 맞으면 검사 대상으로 한다.
+*/
+static bool _i2c_adapter_match (const char *pattern, i2c_adapter_t *adapter)
 {
-	char	i2c_adpter_name[64];
-	char	i2c_addr_str[10], found_i2c = 0, cnt;
+	char node[16];
 
-	memset (i2c_adpter_name, 0x00, sizeof(i2c_adpter_name));
-	_strtok_strcpy(i2c_adpter_name);
+	if (!pattern[0])
+		return false;
 
-	for (cnt = 0; cnt < 2; cnt++) {
-		memset (i2c_addr_str, 0, sizeof(i2c_addr_str));
-		_strtok_strcpy(i2c_addr_str);
-		tolowerstr(i2c_addr_str);
+	snprintf(node, sizeof(node), "i2c-%d", adapter->nr);
+	return	!fnmatch(pattern, adapter->name, 0) || !fnmatch(pattern, node, 0) ||
+			!strncmp(adapter->name, pattern, strlen(pattern));
+}
 
-		if (i2c_addr_str[0] == '0' && i2c_addr_str[1] == 'x')
-			app_data->i2c_test_addr[cnt] = (__u8)(strtoul(i2c_addr_str, NULL, 16));
+//------------------------------------------------------------------------------
+/* 공백으로 구분된 주소 목록 (0x.. = hex, 그 외 10진수), 주소가 없으면 false */
+static bool _parse_addr_list (char *str, i2c_map_t *map)
+{
+	char *ptr, *end;
+	unsigned long addr;
+	bool found = false;
+
+	memset (map, 0x00, sizeof(i2c_map_t));
+	for (ptr = str; *ptr; ptr = end) {
+		ptr = _str_remove_space(ptr);
+		if (ptr[0] == '0' && tolower(ptr[1]) == 'x')
+			addr = strtoul(ptr, &end, 16);
 		else
-			app_data->i2c_test_addr[cnt] = (__u8)(strtoul(i2c_addr_str, NULL, 10));
+			addr = strtoul(ptr, &end, 10);
+		if (end == ptr)
+			break;
+		if (addr < I2C_ADDR_MAX) {
+			I2C_MAP_SET(map, addr);
+			found = true;
+		}
 	}
+	return found;
+}
 
-	for (cnt = 0; cnt < 20; cnt++) {
-		char bname[64], line_str[64];
-		FILE *fp;
-
-		memset (bname,    0x00, sizeof(bname));
-		memset (line_str, 0x00, sizeof(line_str));
+//------------------------------------------------------------------------------
+/* node의 검사 대상을 찾고, 없으면 검사 대상 table에 추가한다. */
+static i2c_target_t *_i2c_target_add (app_data_t *app_data, i2c_adapter_t *adapter)
+{
+	char node[32];
+	i2c_target_t *t;
+	int i;
+
+	snprintf(node, sizeof(node), "/dev/i2c-%d", adapter->nr);
+	for (i = 0; i < app_data->target_cnt; i++)
+		if (!strcmp(app_data->target[i].node, node))
+			return &app_data->target[i];
+
+	t = realloc(app_data->target, (app_data->target_cnt + 1) * sizeof(i2c_target_t));
+	if (t == NULL) {
+		err ("i2c target alloc fail!\n");
+		return NULL;
+	}
+	app_data->target = t;
+	t = &app_data->target[app_data->target_cnt++];
+	memset (t, 0x00, sizeof(i2c_target_t));
+	snprintf(t->node, sizeof(t->node), "%s", node);
+	snprintf(t->name, sizeof(t->name), "%s", adapter->name);
+	return t;
+}
 
-		sprintf(bname, "%si2c-%d/name", I2C_BUS_NAME, cnt);
+//------------------------------------------------------------------------------
+/*
+	I2C, {adapter name pattern}, {1st adapter addr list}, {2nd adapter addr list}, ...
+	pattern과 맞는 adapter를 번호 순으로 찾아 n 번째 adapter는 n 번째 주소 목록을 검사한다.
+	(목록이 adapter 수보다 적으면 마지막 목록을 사용, 같은 adapter는 주소를 합침)
+*/
+void _parse_i2c_config (app_data_t *app_data, i2c_adapter_t *adapter, int a_cnt)
+{
+	char	pattern[64], *ptr;
+	i2c_map_t	addr, next;
+	i2c_target_t *t;
+	int		i, k;
+
+	memset (pattern, 0x00, sizeof(pattern));
+	_strtok_strcpy(pattern);
+	/* 빈 pattern은 모든 adapter(SMBus, DDC 포함)와 맞으므로 사용하지 않는다. */
+	if (!pattern[0]) {
+		err ("I2C adapter name pattern is empty! skip.\n");
+		return;
+	}
+	memset (&addr, 0x00, sizeof(addr));
 
-		if (access (bname, F_OK) < 0)
-			continue;
-		if ((fp = fopen(bname, "r")) < 0)
+	for (i = 0; i < a_cnt; i++) {
+		if (!_i2c_adapter_match (pattern, &adapter[i]))
 			continue;
 
-		if (fgets(line_str, sizeof(line_str)-1, fp) != NULL) {
-			if (!strncmp(i2c_adpter_name, line_str, strlen(i2c_adpter_name)-1)) {
-				if (found_i2c < 2) {
-					memset (app_data->i2c_node_name[found_i2c], 0x00, sizeof(app_data->i2c_node_name[0]));
-					sprintf(app_data->i2c_node_name[found_i2c], "/dev/i2c-%d", cnt);
-					info ("I2C Node = %s, I2C TEST ADDR = 0x%02X\n",
-						app_data->i2c_node_name[found_i2c], app_data->i2c_test_addr[found_i2c]);
-					found_i2c++;
-				}
-			}
-		}
-		fclose(fp);
+		if (((ptr = strtok (NULL, ",")) != NULL) && _parse_addr_list (ptr, &next))
+			addr = next;
+		if ((t = _i2c_target_add (app_data, &adapter[i])) == NULL)
+			break;
+		for (k = 0; k < I2C_ADDR_MAX / 64; k++)
+			t->addr.bits[k] |= addr.bits[k];
+		info ("I2C Node = %s (%s)\n", t->node, t->name);
 	}
 }
 
 //------------------------------------------------------------------------------
-#define	OVERLAY_CFG_FILE	"/root/OverlayConfig/overlay_app.cfg"
-
 bool parse_overlay_cfg_file (app_data_t *app_data)
 {
 	FILE *pfd;
@@ -213,18 +364,17 @@ bool parse_overlay_cfg_file (app_data_t *app_data)
 		}
 
 		ptr = strtok (buf, ",");
+		/* 검사 대상 순서대로 주소 목록을 바꾼다. */
 		if (!strncmp(ptr, "I2C", strlen("I2C"))) {
-			char	i2c_addr_str[16], cnt;
+			char		i2c_addr_str[256];
+			i2c_map_t	addr;
+			int			cnt;
 
-			for (cnt = 0; cnt < 2; cnt++) {
+			for (cnt = 0; cnt < app_data->target_cnt; cnt++) {
 				memset (i2c_addr_str, 0, sizeof(i2c_addr_str));
 				_strtok_strcpy(i2c_addr_str);
-				tolowerstr(i2c_addr_str);
-
-				if (i2c_addr_str[0] == '0' && i2c_addr_str[1] == 'x')
-					app_data->i2c_test_addr[cnt] = (__u8)(strtoul(i2c_addr_str, NULL, 16));
-				else
-					app_data->i2c_test_addr[cnt] = (__u8)(strtoul(i2c_addr_str, NULL, 10));
+				if (_parse_addr_list (i2c_addr_str, &addr))
+					app_data->target[cnt].addr = addr;
 			}
 		}
 		if (!strncmp(ptr, "MAC", strlen("MAC"))) {
@@ -246,8 +396,7 @@ bool parse_overlay_cfg_file (app_data_t *app_data)
 	}
 
 	info ("=== %s === \n", __func__);
-	info ("Check I2C Device Addr = [0x%02x, 0x%02x]\n",
-				app_data->i2c_test_addr[0], app_data->i2c_test_addr[1]);
+	info ("Check I2C adapter count = %d\n", app_data->target_cnt);
 	info ("Check Ethernet name = [%s, %s]\n",
 				app_data->eth_name[0], app_data->eth_name[1]);
 	info ("Check MAC Address Range = [Start : %s - End : %s], Test = %s\n",
@@ -259,16 +408,47 @@ bool parse_overlay_cfg_file (app_data_t *app_data)
 	return true;
 }
 
+//------------------------------------------------------------------------------
+/*
+	SOAK, {quick}, {read byte}, {read word}, {block read}, {block read size}
+	soak mode(--soak)의 전송 종류별 비율 (0 = 사용하지 않음), block read 크기 (1 ~ 32)
+*/
+void _parse_soak_config (app_data_t *app_data)
+{
+	char *ptr;
+	int i;
+
+	for (i = 0; i < eI2C_OP_END; i++)
+		if ((ptr = strtok (NULL, ",")) != NULL)
+			app_data->soak_mix[i] = atoi(ptr);
+
+	if ((ptr = strtok (NULL, ",")) != NULL)
+		app_data->soak_block_len = atoi(ptr);
+	if ((app_data->soak_block_len < 1) || (app_data->soak_block_len > I2C_SMBUS_BLOCK_MAX))
+		app_data->soak_block_len = I2C_SMBUS_BLOCK_MAX;
+}
+
 //------------------------------------------------------------------------------
 bool parse_cfg_file (char *cfg_filename, app_data_t *app_data)
 {
 	FILE *pfd;
 	char buf[256], *ptr, is_cfg_file = 0;
+	i2c_adapter_t *adapter;
+	int a_cnt;
 
 	if ((pfd = fopen(cfg_filename, "r")) == NULL) {
 		err ("%s file open fail!\n", cfg_filename);
 		return false;
 	}
+	/* 설치된 adapter 목록 (I2C 설정과 이름을 비교) */
+	adapter = _i2c_adapter_list (&a_cnt);
+
+	/* SOAK 설정이 없는 경우 : quick write(EEPROM 등에 위험)를 제외한 read 전송 */
+	app_data->soak_mix[eI2C_OP_QUICK]      = 0;
+	app_data->soak_mix[eI2C_OP_READ_BYTE]  = 1;
+	app_data->soak_mix[eI2C_OP_READ_WORD]  = 1;
+	app_data->soak_mix[eI2C_OP_READ_BLOCK] = 1;
+	app_data->soak_block_len = I2C_SMBUS_BLOCK_MAX;
 
 	/* config file에서 1 라인 읽어올 buffer 초기화 */
 	memset (buf, 0, sizeof(buf));
@@ -283,12 +463,14 @@ bool parse_cfg_file (char *cfg_filename, app_data_t *app_data)
 		ptr = strtok (buf, ",");
 		if (!strncmp(ptr, "MODEL", strlen("MODEL")))	_parse_model_name (app_data);
 		if (!strncmp(ptr,    "FB", strlen("FB")))		_parse_fb_config  (app_data);
-		if (!strncmp(ptr,   "I2C", strlen("I2C")))		_parse_i2c_config (app_data);
+		if (!strncmp(ptr,   "I2C", strlen("I2C")))		_parse_i2c_config (app_data, adapter, a_cnt);
+		if (!strncmp(ptr,  "SOAK", strlen("SOAK")))		_parse_soak_config(app_data);
 		memset (buf, 0x00, sizeof(buf));
 	}
 
 	if (pfd)
 		fclose (pfd);
+	free (adapter);
 
 	if (!is_cfg_file) {
 		err("This file is not APP Config File! (filename = %s)\n", cfg_filename);
@@ -302,6 +484,7 @@ bool parse_cfg_file (char *cfg_filename, app_data_t *app_data)
 int main(int argc, char **argv)
 {
 	app_data_t	*app_data;
+	int			ret = 0;
 
     parse_opts(argc, argv);
 
@@ -310,6 +493,13 @@ int main(int argc, char **argv)
 		goto err_out;
 	}
 	memset  (app_data, 0, sizeof(app_data_t));
+	if (OPT_UI_CFG_FILE == NULL)
+		OPT_UI_CFG_FILE = OPT_SCAN_MODE ? SCAN_UI_CFG_FILE : DEFAULT_UI_CFG_FILE;
+	app_data->scan_mode    = OPT_SCAN_MODE;
+	app_data->ui_cfg_file  = OPT_UI_CFG_FILE;
+	app_data->app_cfg_file = OPT_APP_CFG_FILE;
+	app_data->lat_file     = OPT_LAT_FILE;
+	app_data->soak_sec     = OPT_SOAK_SEC;
 
 	info("APP Config file : %s\n", OPT_APP_CFG_FILE);
 	if (!parse_cfg_file ((char *)OPT_APP_CFG_FILE, app_data)) {
@@ -320,11 +510,18 @@ int main(int argc, char **argv)
 	strncpy (app_data->btime, __TIME__, strlen(__TIME__));
 	info ("Application Build : %s / %s\n", app_data->bdate, app_data->btime);
 
+	if (OPT_FB_DEVICE != NULL) {
+		memset  (app_data->fb_dev, 0, sizeof(app_data->fb_dev));
+		strncpy (app_data->fb_dev, OPT_FB_DEVICE, sizeof(app_data->fb_dev) -1);
+	}
 	info("Framebuffer Device : %s\n", app_data->fb_dev);
 	if ((app_data->pfb = fb_init (app_data->fb_dev)) == NULL) {
 		err ("create framebuffer fail!\n");
 		goto err_out;
 	}
+	/* 화면 갱신은 shadow buffer에 그린 후 app_main에서 fb_flush로 반영 */
+	if (!fb_shadow_enable (app_data->pfb, true))
+		err ("shadow buffer disabled. draw directly to framebuffer.\n");
 
 	printf("========== FB SCREENINFO ==========\n");
 	printf("xres   : %d\n", app_data->pfb->w);
@@ -332,6 +529,8 @@ int main(int argc, char **argv)
 	printf("bpp    : %d\n", app_data->pfb->bpp);
 	printf("stride : %d\n", app_data->pfb->stride);
 	printf("bgr    : %d\n", app_data->pfb->is_bgr);
+	printf("format : %s\n", app_data->pfb->fmt->name);
+	printf("pages  : %d\n", app_data->pfb->page_cnt);
 	printf("fb_base     : %p\n", app_data->pfb->base);
 	printf("fb_data     : %p\n", app_data->pfb->data);
 	printf("==================================\n");
@@ -343,14 +542,16 @@ int main(int argc, char **argv)
 	}
 
 	// main control function (server.c)
-	app_main (app_data);
+	ret = app_main (app_data);
 
 err_out:
 	ui_close (app_data->pui);
-	fb_clear (app_data->pfb);
-	fb_close (app_data->pfb);
+	if (app_data->pfb) {
+		fb_clear (app_data->pfb);
+		fb_close (app_data->pfb);
+	}
 
-	return 0;
+	return ret;
 }
 
 //------------------------------------------------------------------------------